@@ -0,0 +1,19 @@
+# Writes OUTPUT with the `git describe --always --dirty` of SOURCE_DIR as QBENCH_GIT_REV. Runs on
+# every build through the qbench_git_rev target and only rewrites OUTPUT when the revision
+# changed, so that an unchanged tree does not recompile anything.
+execute_process(COMMAND git describe --always --dirty
+                WORKING_DIRECTORY ${SOURCE_DIR}
+                OUTPUT_VARIABLE GIT_REV
+                OUTPUT_STRIP_TRAILING_WHITESPACE
+                ERROR_QUIET)
+if(NOT GIT_REV)
+    set(GIT_REV unknown)
+endif()
+
+set(CONTENT "#pragma once\n\n#define QBENCH_GIT_REV \"${GIT_REV}\"\n")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} OLD_CONTENT)
+endif()
+if(NOT "${OLD_CONTENT}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
@@ -18,6 +18,7 @@
 #include "../framework/benchmark_base.h"
 #include "../framework/benchmark_round_trip_latency.h"
 #include "../framework/benchmark_suite.h"
+#include "../framework/cpu_topology.h"
 #include "../framework/benchmark_throughput.h"
 #include "../framework/factory.h"
 #include "detail/common.h"
@@ -31,7 +32,7 @@
 #include <limits>
 #include <type_traits>
 
-int main()
+int main(int argc, char** argv)
 {
 
   std::cout << ThroughputBenchmarkStats::csv_header();
@@ -59,17 +60,17 @@ int main()
 
     std::cout
       << ThroughputBenchmarkSuite(
-           ITERATION_NUM,
-           {benchmark_creator<ThroughputBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N, AtomicQueueProduceAll<ProduceIncremental<MsgType>, AtomicQueueContext>,
+           ITERATION_NUM, placement_scenarios_arg(argc, argv, PRODUCER_N, CONSUMER_N),
+           {placed_benchmark_creator<ThroughputBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N, AtomicQueueProduceAll<ProduceIncremental<MsgType>, AtomicQueueContext>,
                                                   AtomicQueueConsumeAll<ConsumeAndStore<MsgType>, AtomicQueueContext>>,
                               ThroughputBenchmarkSuite::BenchmarkRunResult>(BENCH_NAME, RING_BUFFER_SIZE),
-            benchmark_creator<ThroughputBenchmark<MsgType, BenchmarkContext, PRODUCER_N, CONSUMER_N, MgarkSingleQueueProduceAll<ProduceIncremental<MsgType>, BenchmarkContext>,
+            placed_benchmark_creator<ThroughputBenchmark<MsgType, BenchmarkContext, PRODUCER_N, CONSUMER_N, MgarkSingleQueueProduceAll<ProduceIncremental<MsgType>, BenchmarkContext>,
                                                   MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, BenchmarkContext>>,
                               ThroughputBenchmarkSuite::BenchmarkRunResult>(BENCH_NAME, RING_BUFFER_SIZE),
-            benchmark_creator<ThroughputBenchmark<MsgType0, Spsc1Context, PRODUCER_N, CONSUMER_N, Spsc1SingleQueueProduceAll<ProduceIncremental<MsgType0>, Spsc1Context>,
+            placed_benchmark_creator<ThroughputBenchmark<MsgType0, Spsc1Context, PRODUCER_N, CONSUMER_N, Spsc1SingleQueueProduceAll<ProduceIncremental<MsgType0>, Spsc1Context>,
                                                   Spsc1QueueConsumeAll<ConsumeAndStore<MsgType0>, Spsc1Context>>,
                               ThroughputBenchmarkSuite::BenchmarkRunResult>(BENCH_NAME, RING_BUFFER_SIZE),
-            benchmark_creator<ThroughputBenchmark<MsgType0, Spsc2Context, PRODUCER_N, CONSUMER_N, Spsc2SingleQueueProduceAll<ProduceIncremental<MsgType0>, Spsc2Context>,
+            placed_benchmark_creator<ThroughputBenchmark<MsgType0, Spsc2Context, PRODUCER_N, CONSUMER_N, Spsc2SingleQueueProduceAll<ProduceIncremental<MsgType0>, Spsc2Context>,
                                                   Spsc2QueueConsumeAll<ConsumeAndStore<MsgType0>, Spsc2Context>>,
                               ThroughputBenchmarkSuite::BenchmarkRunResult>(BENCH_NAME, RING_BUFFER_SIZE)})
            .go(N);
@@ -89,8 +90,8 @@ int main()
 
     std::cout
       << ThroughputBenchmarkSuite(
-           ITERATION_NUM,
-           {benchmark_creator<ThroughputBenchmark<MsgType, BenchmarkContext, PRODUCER_N, CONSUMER_N, MgarkSingleQueueProduceAll<ProduceIncremental<MsgType>, BenchmarkContext>,
+           ITERATION_NUM, placement_scenarios_arg(argc, argv, PRODUCER_N, CONSUMER_N),
+           {placed_benchmark_creator<ThroughputBenchmark<MsgType, BenchmarkContext, PRODUCER_N, CONSUMER_N, MgarkSingleQueueProduceAll<ProduceIncremental<MsgType>, BenchmarkContext>,
                                                   MgarkSingleQueueConsumeAll<ConsumeAndStore<MsgType>, BenchmarkContext>>,
                               ThroughputBenchmarkSuite::BenchmarkRunResult>(BENCH_NAME, RING_BUFFER_SIZE)})
            .go(N);
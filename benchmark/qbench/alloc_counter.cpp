@@ -0,0 +1,63 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Counting replacements of the global operator new/delete, which feed AllocationCounter so that
+// every benchmark can report how many bytes its vendor contexts allocate.
+
+#include "../../framework/memory_footprint.h"
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+struct InstallAllocationCounter
+{
+  InstallAllocationCounter() { AllocationCounter::installed = true; }
+} install_allocation_counter;
+
+void* counted_alloc(size_t sz)
+{
+  AllocationCounter::on_alloc(sz);
+  if (void* p = std::malloc(sz ? sz : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void* counted_aligned_alloc(size_t sz, std::align_val_t al)
+{
+  AllocationCounter::on_alloc(sz);
+  size_t alignment = static_cast<size_t>(al);
+  // aligned_alloc wants the size to be a non zero multiple of the alignment
+  size_t aligned_sz = sz ? (sz + alignment - 1) / alignment * alignment : alignment;
+  if (void* p = std::aligned_alloc(alignment, aligned_sz))
+    return p;
+  throw std::bad_alloc();
+}
+} // namespace
+
+void* operator new(size_t sz) { return counted_alloc(sz); }
+void* operator new[](size_t sz) { return counted_alloc(sz); }
+void* operator new(size_t sz, std::align_val_t al) { return counted_aligned_alloc(sz, al); }
+void* operator new[](size_t sz, std::align_val_t al) { return counted_aligned_alloc(sz, al); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
@@ -0,0 +1,37 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_one_way_latency.h"
+#include "../../framework/benchmark_throughput.h"
+#include "grid_bindings.h"
+#include "registrations.h"
+
+// Produce and consume batch sizes from single messages up to whole ring chunks, around the 10-40
+// updates a feed handler typically decodes from one packet. Throughput mode shows what batching
+// buys, one_way mode what it costs every message in latency.
+void register_batch_sweep_benchmarks()
+{
+  using BatchTunings = DriverBatchGrid<ValueList<1, 2, 4, 8, 10, 16, 32, 40, 64, 128, 256>>;
+  using BatchVendors = TypeList<MgarkBatchGridVendor<BatchTunings>, AtomicQueueBatchGridVendor<BatchTunings>,
+                                Spsc1BatchGridVendor<BatchTunings>, Spsc2BatchGridVendor<BatchTunings>>;
+  using Topologies = TypeList<GridTopology<1, 1>, GridTopology<2, 1>>;
+
+  register_grid<ThroughputBenchmark,
+                BenchmarkGrid<BatchVendors, TypeList<Uint32GridMsg, OrderBookGridMsg>, Topologies>>("grid_batch");
+
+  register_grid<OneWayLatencyBenchmark,
+                BenchmarkGrid<BatchVendors, TypeList<TimestampedGridMsg<Uint32GridMsg>>, Topologies>>("grid_batch");
+}
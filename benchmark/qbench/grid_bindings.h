@@ -0,0 +1,268 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../../framework/benchmark_grid.h"
+#include "../../framework/benchmark_one_way_latency.h"
+#include "../../framework/benchmark_registry.h"
+#include "../../framework/checked_message.h"
+#include "../../framework/factory.h"
+#include "../types/order_book.h"
+#include "../types/payload.h"
+#include "../vendor_specs/atomic_queue_spec.h"
+#include "../vendor_specs/mgark_spec.h"
+#include "../vendor_specs/spsc1_spec.h"
+#include "../vendor_specs/spsc2_spec.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+// Vendor and message bindings of the benchmark grids (see framework/benchmark_grid.h) shared by
+// the grid registration TUs.
+
+// multicast for a single consumer, anycast across several, like the hand written mpmc cases
+template <class Tunings>
+struct MgarkGridVendor
+{
+  using tunings = Tunings;
+
+  template <class T, size_t P, size_t C>
+  static constexpr bool supports = true;
+
+  template <class T, size_t P, size_t C, class Tuning>
+  using Context =
+    std::conditional_t<C == 1,
+                       Mgark_MulticastReliableBoundedContext<T, P, C, Tuning::BATCH_NUM, Tuning::CPU_PAUSE_N,
+                                                             PolicyAllocator<T>>,
+                       Mgark_Anycast2ReliableBoundedContext_SingleQueue<T, P, C, Tuning::BATCH_NUM,
+                                                                        Tuning::CPU_PAUSE_N, PolicyAllocator<T>>>;
+
+  template <class ProduceOneMessage, class Ctx, class Tuning>
+  using ProduceAll = MgarkSingleQueueProduceAll<ProduceOneMessage, Ctx>;
+
+  template <class ProcessOneMessage, class Ctx, class Tuning>
+  using ConsumeAll = MgarkSingleQueueNonBlockingConsumeAll<ProcessOneMessage, Ctx>;
+};
+
+// the hand written benchmarks' batch and pause, for sweeps along other axes
+struct MgarkDefaultTuning : BatchPauseTuning<4, 0>
+{
+  static std::string name() { return ""; }
+};
+
+// integral messages use the NIL value flavour, anything else the non atomic one
+struct AtomicQueueGridVendor
+{
+  using tunings = TypeList<DefaultTuning>;
+  static constexpr bool MAXIMIZE_THROUGHPUT = true;
+
+  template <class T, size_t P, size_t C>
+  static constexpr bool supports = true;
+
+  template <class T, size_t P, size_t C>
+  static auto context_of()
+  {
+    if constexpr (std::is_integral_v<T> && P == 1 && C == 1)
+      return std::type_identity<AQ_SPSCBoundedDynamicContext<T, std::numeric_limits<T>::max(), MAXIMIZE_THROUGHPUT,
+                                                             PolicyAllocator<T>>>{};
+    else if constexpr (std::is_integral_v<T>)
+      return std::type_identity<AQ_MPMCBoundedDynamicContext<T, std::numeric_limits<T>::max(), MAXIMIZE_THROUGHPUT,
+                                                             PolicyAllocator<T>>>{};
+    else if constexpr (P == 1 && C == 1)
+      return std::type_identity<AQ_NonAtomic_SPSCBoundedDynamicContext<T, MAXIMIZE_THROUGHPUT, PolicyAllocator<T>>>{};
+    else
+      return std::type_identity<AQ_NonAtomic_MPMCBoundedDynamicContext<T, MAXIMIZE_THROUGHPUT, PolicyAllocator<T>>>{};
+  }
+
+  template <class T, size_t P, size_t C, class Tuning>
+  using Context = typename decltype(context_of<T, P, C>())::type;
+
+  template <class ProduceOneMessage, class Ctx, class Tuning>
+  using ProduceAll = AtomicQueueProduceAll<ProduceOneMessage, Ctx>;
+
+  template <class ProcessOneMessage, class Ctx, class Tuning>
+  using ConsumeAll = AtomicQueueConsumeAll<ProcessOneMessage, Ctx>;
+};
+
+struct Spsc1GridVendor
+{
+  using tunings = TypeList<DefaultTuning>;
+
+  template <class T, size_t P, size_t C>
+  static constexpr bool supports = P == 1 && C == 1;
+
+  template <class T, size_t P, size_t C, class Tuning>
+  using Context = Spsc1BenchmarkContext<T, PolicyAllocator<T>>;
+
+  template <class ProduceOneMessage, class Ctx, class Tuning>
+  using ProduceAll = Spsc1SingleQueueProduceAll<ProduceOneMessage, Ctx>;
+
+  template <class ProcessOneMessage, class Ctx, class Tuning>
+  using ConsumeAll = Spsc1QueueConsumeAll<ProcessOneMessage, Ctx>;
+};
+
+struct Spsc2GridVendor
+{
+  using tunings = TypeList<DefaultTuning>;
+
+  template <class T, size_t P, size_t C>
+  static constexpr bool supports = P == 1 && C == 1;
+
+  template <class T, size_t P, size_t C, class Tuning>
+  using Context = Spsc2BenchmarkContext<T, 4, PolicyAllocator<T>>;
+
+  template <class ProduceOneMessage, class Ctx, class Tuning>
+  using ProduceAll = Spsc2SingleQueueProduceAll<ProduceOneMessage, Ctx>;
+
+  template <class ProcessOneMessage, class Ctx, class Tuning>
+  using ConsumeAll = Spsc2QueueConsumeAll<ProcessOneMessage, Ctx>;
+};
+
+// The same queues driven BATCH_N messages at a time, see DriverBatchTuning. SPSC1 and SPSC2 fill
+// and drain whole batches in their slots, mgark and atomic_queue have no batch API, so their
+// producers publish back to back as usual and their consumers drain at most BATCH_N in a row.
+template <class BatchTunings>
+struct MgarkBatchGridVendor : MgarkGridVendor<BatchTunings>
+{
+  // mgark's bounded drain relies on peek(), which the anycast consumer is not meant for
+  template <class T, size_t P, size_t C>
+  static constexpr bool supports = C == 1;
+
+  template <class T, size_t P, size_t C, class Tuning>
+  using Context = typename MgarkGridVendor<BatchTunings>::template Context<T, P, C, MgarkDefaultTuning>;
+
+  template <class ProcessOneMessage, class Ctx, class Tuning>
+  using ConsumeAll = MgarkSingleQueueBatchConsumeAll<ProcessOneMessage, Ctx, Tuning::BATCH_N>;
+};
+
+template <class BatchTunings>
+struct AtomicQueueBatchGridVendor : AtomicQueueGridVendor
+{
+  using tunings = BatchTunings;
+
+  template <class ProcessOneMessage, class Ctx, class Tuning>
+  using ConsumeAll = AtomicQueueBatchConsumeAll<ProcessOneMessage, Ctx, Tuning::BATCH_N>;
+};
+
+template <class BatchTunings>
+struct Spsc1BatchGridVendor : Spsc1GridVendor
+{
+  using tunings = BatchTunings;
+
+  template <class ProduceOneMessage, class Ctx, class Tuning>
+  using ProduceAll = Spsc1BatchProduceAll<ProduceOneMessage, Ctx, Tuning::BATCH_N>;
+
+  template <class ProcessOneMessage, class Ctx, class Tuning>
+  using ConsumeAll = Spsc1BatchConsumeAll<ProcessOneMessage, Ctx, Tuning::BATCH_N>;
+};
+
+template <class BatchTunings>
+struct Spsc2BatchGridVendor : Spsc2GridVendor
+{
+  using tunings = BatchTunings;
+
+  template <class ProduceOneMessage, class Ctx, class Tuning>
+  using ProduceAll = Spsc2BatchProduceAll<ProduceOneMessage, Ctx, Tuning::BATCH_N>;
+
+  template <class ProcessOneMessage, class Ctx, class Tuning>
+  using ConsumeAll = Spsc2BatchConsumeAll<ProcessOneMessage, Ctx, Tuning::BATCH_N>;
+};
+
+struct Uint32GridMsg
+{
+  using type = uint32_t;
+  using creator = ProduceIncremental<uint32_t>;
+  using processor = ConsumeAndStore<uint32_t>;
+  static constexpr const char* NAME = "uint32";
+};
+
+struct OrderBookGridMsg
+{
+  using type = OrderBook;
+  using creator = ProduceFreshOrderBook<OrderBook>;
+  using processor = ConsumeAndStore<OrderBook>;
+  static constexpr const char* NAME = "orderbook";
+};
+
+// book read in the slot rather than copied out of it, top of book or every level
+template <class Processor, const char* _NAME_>
+struct OrderBookInSlotGridMsg
+{
+  using type = OrderBook;
+  using creator = ProduceFreshOrderBook<OrderBook>;
+  using processor = Processor;
+  static constexpr const char* NAME = _NAME_;
+};
+
+inline constexpr char ORDERBOOK_TOP_NAME[] = "orderbook_top";
+inline constexpr char ORDERBOOK_DEPTH_NAME[] = "orderbook_depth";
+using OrderBookTopGridMsg = OrderBookInSlotGridMsg<ReadTopOfBook<OrderBook>, ORDERBOOK_TOP_NAME>;
+using OrderBookDepthGridMsg = OrderBookInSlotGridMsg<ScanFullBook<OrderBook>, ORDERBOOK_DEPTH_NAME>;
+
+template <size_t Bytes>
+struct PayloadGridMsg
+{
+  using type = Payload<Bytes>;
+  using creator = ProducePayload<Payload<Bytes>>;
+  using processor = ConsumePayload<Payload<Bytes>>;
+  static inline const std::string NAME = "payload" + std::to_string(Bytes);
+};
+
+// any message binding with every message validated on the consumer side, see CheckedMessage
+template <class Msg>
+struct CheckedGridMsg
+{
+  using type = CheckedMessage<typename Msg::type>;
+  using creator = ProduceChecked<typename Msg::type, typename Msg::creator>;
+  using processor = ConsumeChecked<typename Msg::type, typename Msg::processor>;
+  static inline const std::string NAME = std::string("checked_") + Msg::NAME;
+};
+
+// any message binding stamped with the TSC on publish, for OneWayLatencyBenchmark grids
+template <class Msg>
+struct TimestampedGridMsg
+{
+  using type = Timestamped<typename Msg::type>;
+  using creator = ProduceTimestamped<typename Msg::type, typename Msg::creator>;
+  using processor = ConsumeTimestamped<typename Msg::type, typename Msg::processor>;
+  static inline const std::string NAME = Msg::NAME;
+};
+
+template <size_t... Sizes>
+using PayloadGridMsgs = TypeList<PayloadGridMsg<Sizes>...>;
+
+// registers Benchmark<T, Context, PRODUCER_N, CONSUMER_N, ProduceAll, ConsumeAll> for every cell
+template <template <class, class, size_t, size_t, class, class, bool> class Benchmark, class Grid>
+void register_grid(const std::string& prefix)
+{
+  Grid::for_each(prefix,
+                 []<class Vendor, class Msg, class Topology, class Tuning>(const std::string& name)
+                 {
+                   using MsgType = typename Msg::type;
+                   constexpr size_t PRODUCER_N = Topology::PRODUCER_N;
+                   constexpr size_t CONSUMER_N = Topology::CONSUMER_N;
+                   using Context = typename Vendor::template Context<MsgType, PRODUCER_N, CONSUMER_N, Tuning>;
+                   using ConcreteBenchmark =
+                     Benchmark<MsgType, Context, PRODUCER_N, CONSUMER_N,
+                               typename Vendor::template ProduceAll<typename Msg::creator, Context, Tuning>,
+                               typename Vendor::template ConsumeAll<typename Msg::processor, Context, Tuning>, false>;
+
+                   BenchmarkRegistry<typename ConcreteBenchmark::single_run_result>::instance()
+                     .template add<ConcreteBenchmark>(name);
+                 });
+}
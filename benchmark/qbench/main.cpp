@@ -0,0 +1,500 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_load_sweep.h"
+#include "../../framework/benchmark_one_way_latency.h"
+#include "../../framework/benchmark_registry.h"
+#include "../../framework/benchmark_round_trip_latency.h"
+#include "../../framework/benchmark_throughput.h"
+#include "../../framework/cpu_topology.h"
+#include "../../framework/parallel_suite.h"
+#include "../../framework/results_store.h"
+#include "qbench_git_rev.h" // generated on every build, see benchmark/git_rev.cmake
+#include "registrations.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static const char* USAGE =
+  "usage: qbench [options]\n"
+  "  --mode throughput|latency|one_way|load_sweep\n"
+  "                              benchmark kind to run (default throughput)\n"
+  "  --filter REGEX              matched against name/vendor, e.g. 'spsc_.*/mgark'; grid_\n"
+  "                              benchmarks only run when the filter asks for them\n"
+  "  --ring-sizes LIST           comma separated ring buffer sizes (default 1024,65536)\n"
+  "  --msg-num N                 messages per run (default 262144)\n"
+  "  --iterations N              runs per benchmark, the upper bound with --target-ci (default 100)\n"
+  "  --target-ci PCT             stop once the 95% CI of the median is narrower than PCT% of it\n"
+  "  --min-iterations N          runs per benchmark before --target-ci is checked (default 10)\n"
+  "  --producer-cores LIST       e.g. 0,2,4-7; A threads in latency mode\n"
+  "  --consumer-cores LIST       B threads in latency mode\n"
+  "  --placements all|NAMES      smt_sibling,same_ccx,cross_ccx,cross_socket,numa_matrix\n"
+  "  --rate N                    total msg/sec in one_way mode, 0 is unpaced (default 1000000)\n"
+  "  --stamp-every N             throughput time series window in messages, power of 2, 0 is off\n"
+  "                              (default 1024)\n"
+  "  --warmup none|fixed:N|stable[:N]\n"
+  "                              leading messages of every throughput/latency run left out of it\n"
+  "  --alloc-policies LIST       ring buffer backing, each of default|thp|hugetlb[+nodeN][+prefault]\n"
+  "                              (default default)\n"
+  "  --loads LIST                load_sweep offered loads, % of max throughput (default 10-100)\n"
+  "  --results FILE              append raw per-iteration samples as JSON lines, see qbench-compare\n"
+  "  --parallel l3|package       run benchmarks concurrently, one per L3 domain/package, placements\n"
+  "                              are planned within it (default same_ccx)\n"
+  "  --interference-check N      after --parallel, re-run N random benchmarks alone and compare\n"
+  "  --config FILE               'key = value' lines with the same keys as above\n"
+  "  --list                      only print the matching benchmarks\n";
+
+struct QBenchOptions
+{
+  std::string mode{"throughput"};
+  std::string filter;
+  std::vector<size_t> ring_sizes{1024, 1024 * 64};
+  size_t N{1024 * 256};
+  size_t iteration_num{100};
+  AdaptiveStopping stopping;
+  std::vector<size_t> producer_cores;
+  std::vector<size_t> consumer_cores;
+  std::string placements;
+  double msg_per_second{1000000};
+  size_t progress_stamp_every{BenchmarkParams{}.progress_stamp_every};
+  WarmupPolicy warmup;
+  std::vector<AllocationPolicy> alloc_policies{AllocationPolicy{}};
+  std::vector<double> load_pcts{10, 20, 30, 40, 50, 60, 70, 80, 90, 100};
+  std::string results_path;
+  std::string parallel; // empty runs benchmarks one by one
+  size_t interference_check_num{0};
+  bool list{false};
+
+  void set(const std::string& key, const std::string& value)
+  {
+    if (key == "mode")
+      mode = value;
+    else if (key == "filter")
+      filter = value;
+    else if (key == "ring-sizes")
+      ring_sizes = parse_core_list(value); // same comma separated format
+    else if (key == "msg-num")
+      N = std::stoul(value);
+    else if (key == "iterations")
+      iteration_num = std::stoul(value);
+    else if (key == "target-ci")
+      stopping.max_median_ci_pct = std::stod(value);
+    else if (key == "min-iterations")
+      stopping.min_iteration_num = std::stoul(value);
+    else if (key == "producer-cores")
+      producer_cores = parse_core_list(value);
+    else if (key == "consumer-cores")
+      consumer_cores = parse_core_list(value);
+    else if (key == "placements")
+      placements = value;
+    else if (key == "rate")
+      msg_per_second = std::stod(value);
+    else if (key == "stamp-every")
+      progress_stamp_every = std::stoul(value);
+    else if (key == "warmup")
+      warmup = WarmupPolicy::parse(value);
+    else if (key == "alloc-policies")
+      alloc_policies = parse_allocation_policies(value);
+    else if (key == "loads")
+    {
+      load_pcts.clear();
+      std::stringstream ss(value);
+      std::string load;
+      while (std::getline(ss, load, ','))
+        load_pcts.push_back(std::stod(load));
+    }
+    else if (key == "results")
+      results_path = value;
+    else if (key == "parallel")
+    {
+      if (value != "l3" && value != "package")
+        throw std::runtime_error("invalid parallel mode [" + value + "], expected l3 or package");
+      parallel = value;
+    }
+    else if (key == "interference-check")
+      interference_check_num = std::stoul(value);
+    else
+      throw std::runtime_error("unknown option [" + key + "]");
+  }
+
+  // checks across options, only meaningful once the config file and the command line are applied
+  void validate() const
+  {
+    // only throughput and round trip latency runs carve a warmup out of their messages
+    if (warmup.enabled() && mode != "throughput" && mode != "latency")
+      throw std::runtime_error("--warmup is not applied in " + mode + " mode, it can not be used with it");
+
+    // throughput runs cut the warmup at time series windows, without them it would be ignored
+    if (mode == "throughput" && warmup.enabled() && progress_stamp_every == 0)
+    {
+      throw std::runtime_error(
+        "--warmup needs the throughput time series, it can not be used with --stamp-every 0");
+    }
+  }
+};
+
+static std::string trim(const std::string& s)
+{
+  size_t first = s.find_first_not_of(" \t");
+  if (first == std::string::npos)
+    return "";
+  size_t last = s.find_last_not_of(" \t\r");
+  return s.substr(first, last - first + 1);
+}
+
+static void load_config(const std::string& path, QBenchOptions& opts)
+{
+  std::ifstream f(path);
+  if (!f)
+    throw std::runtime_error("could not open config file [" + path + "]");
+
+  std::string line;
+  while (std::getline(f, line))
+  {
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty())
+      continue;
+
+    size_t eq = line.find('=');
+    if (eq == std::string::npos)
+      throw std::runtime_error("invalid config line [" + line + "]");
+
+    opts.set(trim(line.substr(0, eq)), trim(line.substr(eq + 1)));
+  }
+}
+
+static QBenchOptions parse_options(int argc, char** argv)
+{
+  QBenchOptions opts;
+
+  // config file is applied first, so that command line options take precedence
+  for (int i = 1; i + 1 < argc; ++i)
+  {
+    if (std::string("--config") == argv[i])
+      load_config(argv[i + 1], opts);
+  }
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--list")
+    {
+      opts.list = true;
+      continue;
+    }
+
+    if (arg.rfind("--", 0) != 0 || i + 1 >= argc)
+      throw std::runtime_error("invalid argument [" + arg + "]");
+
+    std::string key = arg.substr(2);
+    std::string value = argv[++i];
+    if (key != "config")
+      opts.set(key, value);
+  }
+
+  opts.validate();
+  return opts;
+}
+
+static std::unique_ptr<ResultsStore> open_results(const QBenchOptions& opts)
+{
+  if (opts.results_path.empty())
+    return nullptr;
+  return std::make_unique<ResultsStore>(opts.results_path, RunEnvironment::current(opts.mode, QBENCH_GIT_REV));
+}
+
+// a creator per placement and allocation policy of the benchmark
+template <class Suite, class Entry>
+static void add_creators(std::vector<typename Suite::BenchmarkCreator>& creators,
+                         const QBenchOptions& opts, const Entry* e, size_t ring_buffer_sz,
+                         const std::vector<PlacementScenario>& placements)
+{
+  for (const PlacementScenario& s : placements)
+  {
+    for (const AllocationPolicy& alloc : opts.alloc_policies)
+    {
+      creators.emplace_back(
+        [e, params = BenchmarkParams{ring_buffer_sz, s, opts.msg_per_second,
+                                     opts.progress_stamp_every, opts.warmup, alloc}]()
+        { return e->factory(params); });
+    }
+  }
+}
+
+// every placement and allocation policy of the given benchmarks
+template <class Suite, class Entry>
+static std::vector<typename Suite::BenchmarkCreator> make_creators(
+  const QBenchOptions& opts, const std::vector<const Entry*>& entries, size_t ring_buffer_sz)
+{
+  std::vector<typename Suite::BenchmarkCreator> creators;
+  for (const auto* e : entries)
+  {
+    add_creators<Suite>(creators, opts, e, ring_buffer_sz,
+                        select_placements(opts.placements, e->producer_thread_num,
+                                          e->consumer_thread_num, opts.producer_cores,
+                                          opts.consumer_cores));
+  }
+
+  return creators;
+}
+
+// the placements --parallel plans within every group, "all" stands for every one which fits a group
+static std::vector<std::string> parallel_placement_names(const QBenchOptions& opts)
+{
+  bool by_package = opts.parallel == "package";
+  std::vector<std::string> local = partition_local_placements(by_package);
+  if (opts.placements == "all")
+    return local;
+
+  std::vector<std::string> names;
+  std::stringstream ss(opts.placements.empty() ? "same_ccx" : opts.placements);
+  for (std::string name; std::getline(ss, name, ',');)
+  {
+    if (std::find(begin(local), end(local), name) == end(local))
+    {
+      throw std::runtime_error("placement [" + name + "] spans several " +
+                               (by_package ? "packages" : "L3 domains") +
+                               ", it can not be used with --parallel " + opts.parallel);
+    }
+    names.push_back(name);
+  }
+
+  return names;
+}
+
+// the requested placements planned within group, nothing if the group can not fit all of them, or
+// with "all" any of them
+static std::vector<PlacementScenario> group_placements(const QBenchOptions& opts,
+                                                       const CpuTopology& group,
+                                                       const std::vector<std::string>& names,
+                                                       size_t producer_n, size_t consumer_n)
+{
+  std::vector<PlacementScenario> result;
+  for (PlacementScenario& s : PlacementPlanner(group).plan(producer_n, consumer_n))
+  {
+    if (std::find(begin(names), end(names), s.name) != end(names))
+      result.push_back(std::move(s));
+  }
+
+  if (opts.placements != "all" && result.size() != names.size())
+    result.clear();
+  return result;
+}
+
+template <class Suite, class Entry>
+static std::vector<typename ParallelSuite<Suite>::BenchmarkStats> run_parallel(
+  const QBenchOptions& opts, const std::vector<const Entry*>& entries, size_t ring_buffer_sz,
+  ResultsStore* results)
+{
+  if (!opts.producer_cores.empty() || !opts.consumer_cores.empty())
+    throw std::runtime_error("--parallel places threads itself, explicit core lists do not apply");
+
+  // benchmarks are dealt round robin over the groups, so that each group gets a similar mix, a
+  // benchmark which does not fit its turn's group goes to the next one which fits it
+  std::vector<std::string> names = parallel_placement_names(opts);
+  std::vector<CpuTopology> groups = CpuTopology::load().partition(opts.parallel == "package");
+  std::vector<std::vector<typename Suite::BenchmarkCreator>> group_creators(groups.size());
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    bool placed = false;
+    for (size_t attempt = 0; attempt < groups.size() && !placed; ++attempt)
+    {
+      size_t group = (i + attempt) % groups.size();
+      std::vector<PlacementScenario> placements =
+        group_placements(opts, groups[group], names, entries[i]->producer_thread_num,
+                         entries[i]->consumer_thread_num);
+      if (placements.empty())
+        continue;
+
+      add_creators<Suite>(group_creators[group], opts, entries[i], ring_buffer_sz, placements);
+      placed = true;
+    }
+
+    if (!placed)
+    {
+      throw std::runtime_error("no --parallel " + opts.parallel +
+                               " group fits the placements of [" + entries[i]->id() +
+                               "], run it without --parallel");
+    }
+  }
+
+  std::vector<std::vector<size_t>> group_cpus;
+  for (const CpuTopology& group : groups)
+    group_cpus.push_back(group.cpus());
+
+  ParallelSuite<Suite> suite(opts.iteration_num, std::move(group_creators), std::move(group_cpus));
+  suite.set_adaptive_stopping(opts.stopping);
+  auto stats = suite.go(opts.N);
+  if (results)
+    results->add(suite.records());
+
+  if (opts.interference_check_num)
+  {
+    std::vector<InterferenceCheck> checks =
+      suite.check_interference(opts.interference_check_num, opts.N);
+    std::cerr << "interference check of " << groups.size() << " parallel groups\n"
+              << InterferenceCheck::csv_header();
+    for (const InterferenceCheck& c : checks)
+      std::cerr << c;
+
+    for (const InterferenceCheck& c : checks)
+    {
+      if (c.interfered(0.01, 2))
+      {
+        std::cerr << "WARNING: [" << c.key << "] is " << c.slowdown_pct
+                  << "% worse when run in parallel, its group is not isolated enough\n";
+      }
+    }
+  }
+
+  return stats;
+}
+
+template <class Suite, class BenchmarkStats>
+static void run(const QBenchOptions& opts)
+{
+  using Registry = BenchmarkRegistry<typename Suite::BenchmarkRunResult>;
+  // the benchmark grid is opt-in, it multiplies the hand written cases many times over
+  std::vector<const typename Registry::Entry*> entries =
+    Registry::instance().match(opts.filter.empty() ? "^(?!grid_)" : opts.filter);
+
+  if (opts.list)
+  {
+    for (const auto* e : entries)
+      std::cout << e->id() << "\n";
+    return;
+  }
+
+  std::unique_ptr<ResultsStore> results = open_results(opts);
+  std::cout << BenchmarkStats::csv_header();
+  for (size_t ring_buffer_sz : opts.ring_sizes)
+  {
+    if (!opts.parallel.empty())
+    {
+      std::cout << run_parallel<Suite>(opts, entries, ring_buffer_sz, results.get());
+      continue;
+    }
+
+    Suite suite(opts.iteration_num, make_creators<Suite>(opts, entries, ring_buffer_sz));
+    suite.set_adaptive_stopping(opts.stopping);
+    std::cout << suite.go(opts.N);
+    if (results)
+      results->add(suite.records());
+  }
+}
+
+// open-loop benchmarks only by default, closed-loop producers would hide the queueing delay
+static void run_load_sweep(const QBenchOptions& opts)
+{
+  if (!opts.parallel.empty())
+    throw std::runtime_error("--parallel is not supported in load_sweep mode");
+
+  using Registry = BenchmarkRegistry<OneWayLatencySingleRunResult>;
+  std::vector<const Registry::Entry*> entries =
+    Registry::instance().match(opts.filter.empty() ? "^open_loop_" : opts.filter);
+
+  if (opts.list)
+  {
+    for (const auto* e : entries)
+      std::cout << e->id() << "\n";
+    return;
+  }
+
+  std::unique_ptr<ResultsStore> results = open_results(opts);
+  std::cout << LoadSweepStats::csv_header();
+  for (size_t ring_buffer_sz : opts.ring_sizes)
+  {
+    std::vector<LoadSweep::RatedBenchmarkCreator> creators;
+    for (const auto* e : entries)
+    {
+      for (const PlacementScenario& s :
+           select_placements(opts.placements, e->producer_thread_num, e->consumer_thread_num,
+                             opts.producer_cores, opts.consumer_cores))
+      {
+        for (const AllocationPolicy& alloc : opts.alloc_policies)
+        {
+          creators.emplace_back(
+            [e, ring_buffer_sz, s, alloc](double msg_per_second)
+            {
+              BenchmarkParams params{ring_buffer_sz, s, msg_per_second};
+              params.alloc = alloc;
+              return e->factory(params);
+            });
+        }
+      }
+    }
+
+    LoadSweep sweep(opts.iteration_num, std::move(creators), opts.load_pcts);
+    sweep.set_adaptive_stopping(opts.stopping);
+    std::cout << sweep.go(opts.N);
+    if (results)
+      results->add(sweep.records());
+  }
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      if (std::string("--help") == argv[i])
+      {
+        std::cout << USAGE;
+        return 0;
+      }
+    }
+
+    QBenchOptions opts = parse_options(argc, argv);
+
+    register_throughput_uint32_benchmarks();
+    register_throughput_big_object_benchmarks();
+    register_round_trip_latency_uint32_benchmarks();
+    register_round_trip_latency_big_object_benchmarks();
+    register_one_way_latency_benchmarks();
+    register_realistic_workload_benchmarks();
+    register_open_loop_latency_benchmarks();
+    register_throughput_grid_benchmarks();
+    register_throughput_grid_payload_benchmarks();
+    register_throughput_grid_in_slot_benchmarks();
+    register_throughput_grid_checked_benchmarks();
+    register_batch_sweep_benchmarks();
+
+    if (opts.mode == "throughput")
+      run<ThroughputBenchmarkSuite, ThroughputBenchmarkStats>(opts);
+    else if (opts.mode == "latency")
+      run<LatencyBenchmarkSuite, LatencyBenchmarkStats>(opts);
+    else if (opts.mode == "one_way")
+      run<OneWayLatencyBenchmarkSuite, OneWayLatencyBenchmarkStats>(opts);
+    else if (opts.mode == "load_sweep")
+      run_load_sweep(opts);
+    else
+      throw std::runtime_error("unknown mode [" + opts.mode + "]");
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "ERROR: " << e.what() << "\n" << USAGE;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_one_way_latency.h"
+#include "../../framework/benchmark_registry.h"
+#include "../../framework/factory.h"
+#include "../types/order_book.h"
+#include "../vendor_specs/atomic_queue_spec.h"
+#include "../vendor_specs/mgark_spec.h"
+#include "../vendor_specs/spsc1_spec.h"
+#include "../vendor_specs/spsc2_spec.h"
+#include "registrations.h"
+#include <cstdint>
+
+// same combinations as the one-way tests, but producers follow an open-loop timetable and
+// latency is taken from the intended send time, these are the ones the load sweep runs
+void register_open_loop_latency_benchmarks()
+{
+  auto& registry = BenchmarkRegistry<OneWayLatencySingleRunResult>::instance();
+
+  constexpr bool _MAXIMIZE_THROUGHOUT_ = false;
+
+  // SPSC open-loop latency tests
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 1;
+    constexpr const char* BENCH_NAME = "open_loop_spsc_uint32";
+
+    using PayloadType = uint32_t;
+    using MsgType = Timestamped<PayloadType>;
+    using MsgCreator = ProduceTimestamped<PayloadType, ProduceIncremental<PayloadType>, OpenLoopPacer>;
+    using MsgProcessor = ConsumeTimestamped<PayloadType, ConsumeAndStore<PayloadType>>;
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 0, PolicyAllocator<MsgType>>;
+    using AtomicQueueContext =
+      AQ_NonAtomic_SPSCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+    using Spsc1Context = Spsc1BenchmarkContext<MsgType, PolicyAllocator<MsgType>>;
+    using Spsc2Context = Spsc2BenchmarkContext<MsgType, 4, PolicyAllocator<MsgType>>;
+
+    registry.add<OneWayLatencyBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                        AtomicQueueProduceAll<MsgCreator, AtomicQueueContext>,
+                                        AtomicQueueConsumeAll<MsgProcessor, AtomicQueueContext>>>(BENCH_NAME);
+    registry.add<OneWayLatencyBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                        MgarkSingleQueueProduceAll<MsgCreator, MgarkBenchmarkContext>,
+                                        MgarkSingleQueueNonBlockingConsumeAll<MsgProcessor, MgarkBenchmarkContext>>>(BENCH_NAME);
+    registry.add<OneWayLatencyBenchmark<MsgType, Spsc1Context, PRODUCER_N, CONSUMER_N,
+                                        Spsc1SingleQueueProduceAll<MsgCreator, Spsc1Context>,
+                                        Spsc1QueueConsumeAll<MsgProcessor, Spsc1Context>>>(BENCH_NAME);
+    registry.add<OneWayLatencyBenchmark<MsgType, Spsc2Context, PRODUCER_N, CONSUMER_N,
+                                        Spsc2SingleQueueProduceAll<MsgCreator, Spsc2Context>,
+                                        Spsc2QueueConsumeAll<MsgProcessor, Spsc2Context>>>(BENCH_NAME);
+  }
+
+  // MPSC open-loop latency tests
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 2;
+    constexpr const char* BENCH_NAME = "open_loop_mpsc_uint32";
+
+    using PayloadType = uint32_t;
+    using MsgType = Timestamped<PayloadType>;
+    using MsgCreator = ProduceTimestamped<PayloadType, ProduceIncremental<PayloadType>, OpenLoopPacer>;
+    using MsgProcessor = ConsumeTimestamped<PayloadType, ConsumeAndStore<PayloadType>>;
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 0, PolicyAllocator<MsgType>>;
+    using AtomicQueueContext =
+      AQ_NonAtomic_MPMCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+
+    registry.add<OneWayLatencyBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                        AtomicQueueProduceAll<MsgCreator, AtomicQueueContext>,
+                                        AtomicQueueConsumeAll<MsgProcessor, AtomicQueueContext>>>(BENCH_NAME);
+    registry.add<OneWayLatencyBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                        MgarkSingleQueueProduceAll<MsgCreator, MgarkBenchmarkContext>,
+                                        MgarkSingleQueueNonBlockingConsumeAll<MsgProcessor, MgarkBenchmarkContext>>>(BENCH_NAME);
+  }
+
+  // SPSC open-loop latency tests with a big payload
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 1;
+    constexpr const char* BENCH_NAME = "open_loop_spsc_orderbook";
+
+    using PayloadType = OrderBook;
+    using MsgType = Timestamped<PayloadType>;
+    using MsgCreator = ProduceTimestamped<PayloadType, ProduceFreshOrderBook<PayloadType>, OpenLoopPacer>;
+    using MsgProcessor = ConsumeTimestamped<PayloadType, ConsumeAndStore<PayloadType>>;
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 1, PolicyAllocator<MsgType>>;
+    using AtomicQueueContext =
+      AQ_NonAtomic_SPSCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+
+    registry.add<OneWayLatencyBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                        AtomicQueueProduceAll<MsgCreator, AtomicQueueContext>,
+                                        AtomicQueueConsumeAll<MsgProcessor, AtomicQueueContext>>>(BENCH_NAME);
+    registry.add<OneWayLatencyBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                        MgarkSingleQueueProduceAll<MsgCreator, MgarkBenchmarkContext>,
+                                        MgarkSingleQueueNonBlockingConsumeAll<MsgProcessor, MgarkBenchmarkContext>>>(BENCH_NAME);
+  }
+}
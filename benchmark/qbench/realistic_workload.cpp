@@ -0,0 +1,119 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_realistic_workload.h"
+#include "../../framework/benchmark_registry.h"
+#include "../../framework/factory.h"
+#include "../types/order_book.h"
+#include "../vendor_specs/atomic_queue_spec.h"
+#include "../vendor_specs/mgark_spec.h"
+#include "../vendor_specs/spsc1_spec.h"
+#include "../vendor_specs/spsc2_spec.h"
+#include "registrations.h"
+#include <cstdint>
+
+// Poisson arrivals with --rate as the mean, producers run branchy code and consumers walk a
+// buffer bigger than L2 in between messages
+void register_realistic_workload_benchmarks()
+{
+  auto& registry = BenchmarkRegistry<OneWayLatencySingleRunResult>::instance();
+
+  constexpr bool _MAXIMIZE_THROUGHOUT_ = false;
+  using ProducerWork = BranchyWork<256>;
+  using ConsumerWork = MemoryWalkWork<16, 64>;
+
+  // SPSC realistic workload tests
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 1;
+    constexpr const char* BENCH_NAME = "realistic_spsc_uint32";
+
+    using PayloadType = uint32_t;
+    using MsgType = Timestamped<PayloadType>;
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 0, PolicyAllocator<MsgType>>;
+    using AtomicQueueContext =
+      AQ_NonAtomic_SPSCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+    using Spsc1Context = Spsc1BenchmarkContext<MsgType, PolicyAllocator<MsgType>>;
+    using Spsc2Context = Spsc2BenchmarkContext<MsgType, 4, PolicyAllocator<MsgType>>;
+
+    registry.add<RealisticWorkloadBenchmark<PayloadType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                            AtomicQueueProduceAll, AtomicQueueConsumeAll,
+                                            ProduceIncremental<PayloadType>, ConsumeAndStore<PayloadType>,
+                                            ExponentialArrivals, ProducerWork, ConsumerWork>>(BENCH_NAME);
+    registry.add<RealisticWorkloadBenchmark<PayloadType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                            MgarkSingleQueueProduceAll, MgarkSingleQueueNonBlockingConsumeAll,
+                                            ProduceIncremental<PayloadType>, ConsumeAndStore<PayloadType>,
+                                            ExponentialArrivals, ProducerWork, ConsumerWork>>(BENCH_NAME);
+    registry.add<RealisticWorkloadBenchmark<PayloadType, Spsc1Context, PRODUCER_N, CONSUMER_N,
+                                            Spsc1SingleQueueProduceAll, Spsc1QueueConsumeAll,
+                                            ProduceIncremental<PayloadType>, ConsumeAndStore<PayloadType>,
+                                            ExponentialArrivals, ProducerWork, ConsumerWork>>(BENCH_NAME);
+    registry.add<RealisticWorkloadBenchmark<PayloadType, Spsc2Context, PRODUCER_N, CONSUMER_N,
+                                            Spsc2SingleQueueProduceAll, Spsc2QueueConsumeAll,
+                                            ProduceIncremental<PayloadType>, ConsumeAndStore<PayloadType>,
+                                            ExponentialArrivals, ProducerWork, ConsumerWork>>(BENCH_NAME);
+  }
+
+  // SPSC realistic workload tests with a big payload
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 1;
+    constexpr const char* BENCH_NAME = "realistic_spsc_orderbook";
+
+    using PayloadType = OrderBook;
+    using MsgType = Timestamped<PayloadType>;
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 1, PolicyAllocator<MsgType>>;
+    using AtomicQueueContext =
+      AQ_NonAtomic_SPSCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+
+    registry.add<RealisticWorkloadBenchmark<PayloadType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                            AtomicQueueProduceAll, AtomicQueueConsumeAll,
+                                            ProduceFreshOrderBook<PayloadType>, ConsumeAndStore<PayloadType>,
+                                            ExponentialArrivals, ProducerWork, ConsumerWork>>(BENCH_NAME);
+    registry.add<RealisticWorkloadBenchmark<PayloadType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                            MgarkSingleQueueProduceAll, MgarkSingleQueueNonBlockingConsumeAll,
+                                            ProduceFreshOrderBook<PayloadType>, ConsumeAndStore<PayloadType>,
+                                            ExponentialArrivals, ProducerWork, ConsumerWork>>(BENCH_NAME);
+  }
+
+  // MPSC realistic workload tests, uniform arrivals from every producer
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 2;
+    constexpr const char* BENCH_NAME = "realistic_mpsc_uint32";
+
+    using PayloadType = uint32_t;
+    using MsgType = Timestamped<PayloadType>;
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 0, PolicyAllocator<MsgType>>;
+    using AtomicQueueContext =
+      AQ_NonAtomic_MPMCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+
+    registry.add<RealisticWorkloadBenchmark<PayloadType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                            AtomicQueueProduceAll, AtomicQueueConsumeAll,
+                                            ProduceIncremental<PayloadType>, ConsumeAndStore<PayloadType>,
+                                            UniformArrivals, ProducerWork, ConsumerWork>>(BENCH_NAME);
+    registry.add<RealisticWorkloadBenchmark<PayloadType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                            MgarkSingleQueueProduceAll, MgarkSingleQueueNonBlockingConsumeAll,
+                                            ProduceIncremental<PayloadType>, ConsumeAndStore<PayloadType>,
+                                            UniformArrivals, ProducerWork, ConsumerWork>>(BENCH_NAME);
+  }
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// every registration TU adds its vendor/message/topology combinations to the BenchmarkRegistry,
+// main calls them explicitly so that nothing depends on static initialization order
+void register_throughput_uint32_benchmarks();
+void register_throughput_big_object_benchmarks();
+void register_round_trip_latency_uint32_benchmarks();
+void register_round_trip_latency_big_object_benchmarks();
+void register_one_way_latency_benchmarks();
+void register_realistic_workload_benchmarks();
+void register_open_loop_latency_benchmarks();
+void register_throughput_grid_benchmarks();
+void register_throughput_grid_payload_benchmarks();
+void register_throughput_grid_in_slot_benchmarks();
+void register_throughput_grid_checked_benchmarks();
+void register_batch_sweep_benchmarks();
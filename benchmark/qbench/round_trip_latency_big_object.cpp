@@ -0,0 +1,91 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_registry.h"
+#include "../../framework/benchmark_round_trip_latency.h"
+#include "../../framework/factory.h"
+#include "../types/order_book.h"
+#include "../vendor_specs/atomic_queue_spec.h"
+#include "../vendor_specs/mgark_spec.h"
+#include "registrations.h"
+
+void register_round_trip_latency_big_object_benchmarks()
+{
+  auto& registry = BenchmarkRegistry<LatencySingleRunResult>::instance();
+
+  constexpr bool _MAXIMIZE_THROUGHOUT_ = false;
+  using MsgType = OrderBook;
+
+  // SPSC round-trip latency  tests
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 1;
+    constexpr size_t THREAD_NUM = 1;
+    constexpr const char* BENCH_NAME = "spsc_big_object";
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 0, PolicyAllocator<MsgType>>;
+    using AQBenchmarkContext =
+      AQ_NonAtomic_MPMCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+
+    registry.add<LatencyBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N, THREAD_NUM,
+                                  MgarkSingleQueueLatencyA<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>, MgarkBenchmarkContext>,
+                                  MgarkSingleQueueLatencyB<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>, MgarkBenchmarkContext>>>(BENCH_NAME);
+    registry.add<LatencyBenchmark<MsgType, AQBenchmarkContext, PRODUCER_N, CONSUMER_N, THREAD_NUM,
+                                  AQLatencyA<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>>,
+                                  AQLatencyB<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>>>>(BENCH_NAME);
+  }
+
+  // MPSC round-trip latency  tests
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 2;
+    constexpr size_t THREAD_NUM = 1;
+    constexpr const char* BENCH_NAME = "mpsc_big_object";
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 0, PolicyAllocator<MsgType>>;
+    using AQBenchmarkContext =
+      AQ_NonAtomic_MPMCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+
+    registry.add<LatencyBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N, THREAD_NUM,
+                                  MgarkSingleQueueLatencyA<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>, MgarkBenchmarkContext>,
+                                  MgarkSingleQueueLatencyB<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>, MgarkBenchmarkContext>>>(BENCH_NAME);
+    registry.add<LatencyBenchmark<MsgType, AQBenchmarkContext, PRODUCER_N, CONSUMER_N, THREAD_NUM,
+                                  AQLatencyA<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>>,
+                                  AQLatencyB<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>>>>(BENCH_NAME);
+  }
+
+  // MPMC round-trip latency  tests
+  {
+    constexpr size_t CONSUMER_N = 2;
+    constexpr size_t PRODUCER_N = 2;
+    constexpr size_t THREAD_NUM = 2;
+    constexpr const char* BENCH_NAME = "mpmc_orderbook";
+
+    using MgarkBenchmarkContext =
+      Mgark_Anycast2ReliableBoundedContext_SingleQueue<MsgType, PRODUCER_N, CONSUMER_N, 4, 0, PolicyAllocator<MsgType>>;
+    using AQBenchmarkContext =
+      AQ_NonAtomic_MPMCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+
+    registry.add<LatencyBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N, THREAD_NUM,
+                                  MgarkSingleQueueLatencyA<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>, MgarkBenchmarkContext>,
+                                  MgarkSingleQueueLatencyB<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>, MgarkBenchmarkContext>>>(BENCH_NAME);
+    registry.add<LatencyBenchmark<MsgType, AQBenchmarkContext, PRODUCER_N, CONSUMER_N, THREAD_NUM,
+                                  AQLatencyA<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>>,
+                                  AQLatencyB<ProduceFreshOrderBook<MsgType>, ConsumeAndStore<MsgType>>>>(BENCH_NAME);
+  }
+}
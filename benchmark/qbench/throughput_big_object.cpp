@@ -0,0 +1,124 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_registry.h"
+#include "../../framework/benchmark_throughput.h"
+#include "../../framework/factory.h"
+#include "../types/order_book.h"
+#include "../vendor_specs/atomic_queue_spec.h"
+#include "../vendor_specs/mgark_spec.h"
+#include "../vendor_specs/spsc1_spec.h"
+#include "../vendor_specs/spsc2_spec.h"
+#include "registrations.h"
+
+void register_throughput_big_object_benchmarks()
+{
+  auto& registry = BenchmarkRegistry<ThroughputSingleRunResult>::instance();
+
+  constexpr bool _MAXIMIZE_THROUGHOUT_ = true;
+  using MsgType = OrderBook;
+
+  // SPSC  tests
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 1;
+    constexpr const char* BENCH_NAME = "spsc_orderbook";
+    constexpr const char* IN_PLACE_BENCH_NAME = "spsc_orderbook_inplace";
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 1, PolicyAllocator<MsgType>>;
+    using MgarkInPlaceBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<InPlaceMessage<MsgType>, PRODUCER_N, CONSUMER_N, 4, 1, PolicyAllocator<InPlaceMessage<MsgType>>>;
+    using AtomicQueueContext =
+      AQ_NonAtomic_SPSCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+    using Spsc1Context = Spsc1BenchmarkContext<MsgType, PolicyAllocator<MsgType>>;
+    using Spsc2Context = Spsc2BenchmarkContext<MsgType, 4, PolicyAllocator<MsgType>>;
+
+    registry.add<ThroughputBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                     AtomicQueueProduceAll<ProduceFreshOrderBook<MsgType>, AtomicQueueContext>,
+                                     AtomicQueueConsumeAll<ConsumeAndStore<MsgType>, AtomicQueueContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                     MgarkSingleQueueProduceAll<ProduceFreshOrderBook<MsgType>, MgarkBenchmarkContext>,
+                                     MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, MgarkBenchmarkContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, Spsc1Context, PRODUCER_N, CONSUMER_N,
+                                     Spsc1SingleQueueProduceAll<ProduceFreshOrderBook<MsgType>, Spsc1Context>,
+                                     Spsc1QueueConsumeAll<ConsumeAndStore<MsgType>, Spsc1Context>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, Spsc2Context, PRODUCER_N, CONSUMER_N,
+                                     Spsc2SingleQueueProduceAll<ProduceFreshOrderBook<MsgType>, Spsc2Context>,
+                                     Spsc2QueueConsumeAll<ConsumeAndStore<MsgType>, Spsc2Context>>>(BENCH_NAME);
+
+    // the same books written straight into the queue slots instead of copied through the stack
+    registry.add<ThroughputBenchmark<InPlaceMessage<MsgType>, MgarkInPlaceBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                     MgarkSingleQueueInPlaceProduceAll<ProduceFreshOrderBook<MsgType>, MgarkInPlaceBenchmarkContext>,
+                                     MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, MgarkInPlaceBenchmarkContext>>>(IN_PLACE_BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, Spsc1Context, PRODUCER_N, CONSUMER_N,
+                                     Spsc1SingleQueueInPlaceProduceAll<ProduceFreshOrderBook<MsgType>, Spsc1Context>,
+                                     Spsc1QueueConsumeAll<ConsumeAndStore<MsgType>, Spsc1Context>>>(IN_PLACE_BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, Spsc2Context, PRODUCER_N, CONSUMER_N,
+                                     Spsc2SingleQueueInPlaceProduceAll<ProduceFreshOrderBook<MsgType>, Spsc2Context>,
+                                     Spsc2QueueConsumeAll<ConsumeAndStore<MsgType>, Spsc2Context>>>(IN_PLACE_BENCH_NAME);
+  }
+
+  // MPSC  multicast tests single consumer!
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 3;
+    constexpr const char* BENCH_NAME = "mpsc_orderbook";
+    constexpr const char* IN_PLACE_BENCH_NAME = "mpsc_orderbook_inplace";
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, 4, 10, PolicyAllocator<MsgType>>;
+    using MgarkInPlaceBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<InPlaceMessage<MsgType>, PRODUCER_N, CONSUMER_N, 4, 10, PolicyAllocator<InPlaceMessage<MsgType>>>;
+    using AtomicQueueContext =
+      AQ_NonAtomic_MPMCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+
+    registry.add<ThroughputBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                     AtomicQueueProduceAll<ProduceFreshOrderBook<MsgType>, AtomicQueueContext>,
+                                     AtomicQueueConsumeAll<ConsumeAndStore<MsgType>, AtomicQueueContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                     MgarkSingleQueueProduceAll<ProduceFreshOrderBook<MsgType>, MgarkBenchmarkContext>,
+                                     MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, MgarkBenchmarkContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<InPlaceMessage<MsgType>, MgarkInPlaceBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                     MgarkSingleQueueInPlaceProduceAll<ProduceFreshOrderBook<MsgType>, MgarkInPlaceBenchmarkContext>,
+                                     MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, MgarkInPlaceBenchmarkContext>>>(IN_PLACE_BENCH_NAME);
+  }
+
+  // MPMC  anycast tests, multiple consumers!
+  {
+    constexpr size_t CONSUMER_N = 2;
+    constexpr size_t PRODUCER_N = 2;
+    constexpr const char* BENCH_NAME = "mpmc_orderbook";
+    constexpr const char* IN_PLACE_BENCH_NAME = "mpmc_orderbook_inplace";
+
+    using MgarkBenchmarkContext =
+      Mgark_Anycast2ReliableBoundedContext_SingleQueue<MsgType, PRODUCER_N, CONSUMER_N, 4, 10, PolicyAllocator<MsgType>>;
+    using MgarkInPlaceBenchmarkContext =
+      Mgark_Anycast2ReliableBoundedContext_SingleQueue<InPlaceMessage<MsgType>, PRODUCER_N, CONSUMER_N, 4, 10, PolicyAllocator<InPlaceMessage<MsgType>>>;
+    using AtomicQueueContext =
+      AQ_NonAtomic_MPMCBoundedDynamicContext<MsgType, _MAXIMIZE_THROUGHOUT_, PolicyAllocator<MsgType>>;
+
+    registry.add<ThroughputBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                     AtomicQueueProduceAll<ProduceFreshOrderBook<MsgType>, AtomicQueueContext>,
+                                     AtomicQueueConsumeAll<ConsumeAndStore<MsgType>, AtomicQueueContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                     MgarkSingleQueueProduceAll<ProduceFreshOrderBook<MsgType>, MgarkBenchmarkContext>,
+                                     MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, MgarkBenchmarkContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<InPlaceMessage<MsgType>, MgarkInPlaceBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                     MgarkSingleQueueInPlaceProduceAll<ProduceFreshOrderBook<MsgType>, MgarkInPlaceBenchmarkContext>,
+                                     MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, MgarkInPlaceBenchmarkContext>>>(IN_PLACE_BENCH_NAME);
+  }
+}
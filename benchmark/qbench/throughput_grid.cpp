@@ -0,0 +1,30 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_throughput.h"
+#include "grid_bindings.h"
+#include "registrations.h"
+
+// Every grid block lives in a TU of its own, throughput_grid_<block>.cpp, as each instantiates
+// dozens of benchmarks. This one is the vendor x message x topology core with the mgark tunings.
+void register_throughput_grid_benchmarks()
+{
+  using MgarkTunings = BatchPauseGrid<ValueList<4, 8, 16, 32>, ValueList<0, 10, 30>>;
+  register_grid<ThroughputBenchmark, BenchmarkGrid<
+    TypeList<MgarkGridVendor<MgarkTunings>, AtomicQueueGridVendor, Spsc1GridVendor, Spsc2GridVendor>,
+    TypeList<Uint32GridMsg, OrderBookGridMsg>,
+    TypeList<GridTopology<1, 1>, GridTopology<2, 1>, GridTopology<2, 2>>>>("grid");
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_throughput.h"
+#include "grid_bindings.h"
+#include "registrations.h"
+
+void register_throughput_grid_checked_benchmarks()
+{
+  // checked mode: loss, duplication, reordering and torn reads of small and big messages
+  register_grid<ThroughputBenchmark, BenchmarkGrid<
+    TypeList<MgarkGridVendor<TypeList<MgarkDefaultTuning>>, AtomicQueueGridVendor, Spsc1GridVendor, Spsc2GridVendor>,
+    TypeList<CheckedGridMsg<Uint32GridMsg>, CheckedGridMsg<OrderBookGridMsg>, CheckedGridMsg<PayloadGridMsg<4096>>>,
+    TypeList<GridTopology<1, 1>, GridTopology<2, 1>, GridTopology<2, 2>>>>("grid");
+}
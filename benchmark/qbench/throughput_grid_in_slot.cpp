@@ -0,0 +1,29 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_throughput.h"
+#include "grid_bindings.h"
+#include "registrations.h"
+
+void register_throughput_grid_in_slot_benchmarks()
+{
+  // consumers reading books in place, next to grid_*_orderbook which copies every book out;
+  // atomic_queue is left out as its pop() copies the book out anyway
+  register_grid<ThroughputBenchmark, BenchmarkGrid<
+    TypeList<MgarkGridVendor<TypeList<MgarkDefaultTuning>>, Spsc1GridVendor, Spsc2GridVendor>,
+    TypeList<OrderBookTopGridMsg, OrderBookDepthGridMsg>,
+    TypeList<GridTopology<1, 1>, GridTopology<2, 1>, GridTopology<2, 2>>>>("grid");
+}
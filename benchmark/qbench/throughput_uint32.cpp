@@ -0,0 +1,110 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/benchmark_registry.h"
+#include "../../framework/benchmark_throughput.h"
+#include "../../framework/factory.h"
+#include "../vendor_specs/atomic_queue_spec.h"
+#include "../vendor_specs/mgark_spec.h"
+#include "../vendor_specs/spsc1_spec.h"
+#include "../vendor_specs/spsc2_spec.h"
+#include "registrations.h"
+#include <cstdint>
+#include <limits>
+
+void register_throughput_uint32_benchmarks()
+{
+  auto& registry = BenchmarkRegistry<ThroughputSingleRunResult>::instance();
+
+  constexpr bool _MAXIMIZE_THROUGHOUT_ = true;
+  constexpr size_t BATCH_NUM = 32;
+  using MsgType = uint32_t;
+
+  // SPSC  tests
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 1;
+    constexpr size_t CPU_PAUSE_N = 0;
+    constexpr const char* BENCH_NAME = "spsc_uint32";
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, BATCH_NUM, CPU_PAUSE_N, PolicyAllocator<MsgType>>;
+    using AtomicQueueContext =
+      AQ_SPSCBoundedDynamicContext<MsgType, std::numeric_limits<MsgType>::max(), _MAXIMIZE_THROUGHOUT_,
+                                   PolicyAllocator<MsgType>>;
+    using Spsc1Context = Spsc1BenchmarkContext<MsgType, PolicyAllocator<MsgType>>;
+    using Spsc2Context = Spsc2BenchmarkContext<MsgType, 4, PolicyAllocator<MsgType>>;
+
+    registry.add<ThroughputBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                     AtomicQueueProduceAll<ProduceIncremental<MsgType>, AtomicQueueContext>,
+                                     AtomicQueueConsumeAll<ConsumeAndStore<MsgType>, AtomicQueueContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                     MgarkSingleQueueProduceAll<ProduceIncremental<MsgType>, MgarkBenchmarkContext>,
+                                     MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, MgarkBenchmarkContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, Spsc1Context, PRODUCER_N, CONSUMER_N,
+                                     Spsc1SingleQueueProduceAll<ProduceIncremental<MsgType>, Spsc1Context>,
+                                     Spsc1QueueConsumeAll<ConsumeAndStore<MsgType>, Spsc1Context>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, Spsc2Context, PRODUCER_N, CONSUMER_N,
+                                     Spsc2SingleQueueProduceAll<ProduceIncremental<MsgType>, Spsc2Context>,
+                                     Spsc2QueueConsumeAll<ConsumeAndStore<MsgType>, Spsc2Context>>>(BENCH_NAME);
+  }
+
+  // MPSC  multicast tests single consumer!
+  {
+    constexpr size_t CONSUMER_N = 1;
+    constexpr size_t PRODUCER_N = 2;
+    // the original main had `constexpr bool _CPU_PAUSE_N_ = 30`, i.e. 1, and the name keeps
+    // meaning that configuration, 30 pauses are covered by grid_*_uint32_batch32_pause30
+    constexpr size_t CPU_PAUSE_N = 1;
+    constexpr const char* BENCH_NAME = "mpsc_uint32";
+
+    using MgarkBenchmarkContext =
+      Mgark_MulticastReliableBoundedContext<MsgType, PRODUCER_N, CONSUMER_N, BATCH_NUM, CPU_PAUSE_N, PolicyAllocator<MsgType>>;
+    using AtomicQueueContext =
+      AQ_MPMCBoundedDynamicContext<MsgType, std::numeric_limits<MsgType>::max(), _MAXIMIZE_THROUGHOUT_,
+                                   PolicyAllocator<MsgType>>;
+
+    registry.add<ThroughputBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                     AtomicQueueProduceAll<ProduceIncremental<MsgType>, AtomicQueueContext>,
+                                     AtomicQueueConsumeAll<ConsumeAndStore<MsgType>, AtomicQueueContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                     MgarkSingleQueueProduceAll<ProduceIncremental<MsgType>, MgarkBenchmarkContext>,
+                                     MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, MgarkBenchmarkContext>>>(BENCH_NAME);
+  }
+
+  // MPMC  anycast tests, multiple consumers!
+  {
+    constexpr size_t CONSUMER_N = 2;
+    constexpr size_t PRODUCER_N = 2;
+    // the original main had `constexpr bool _CPU_PAUSE_N_ = 30`, i.e. 1, and the name keeps
+    // meaning that configuration, 30 pauses are covered by grid_*_uint32_batch32_pause30
+    constexpr size_t CPU_PAUSE_N = 1;
+    constexpr const char* BENCH_NAME = "mpmc_uint32";
+
+    using MgarkBenchmarkContext =
+      Mgark_Anycast2ReliableBoundedContext_SingleQueue<MsgType, PRODUCER_N, CONSUMER_N, BATCH_NUM, CPU_PAUSE_N, PolicyAllocator<MsgType>>;
+    using AtomicQueueContext =
+      AQ_MPMCBoundedDynamicContext<MsgType, std::numeric_limits<MsgType>::max(), _MAXIMIZE_THROUGHOUT_,
+                                   PolicyAllocator<MsgType>>;
+
+    registry.add<ThroughputBenchmark<MsgType, AtomicQueueContext, PRODUCER_N, CONSUMER_N,
+                                     AtomicQueueProduceAll<ProduceIncremental<MsgType>, AtomicQueueContext>,
+                                     AtomicQueueConsumeAll<ConsumeAndStore<MsgType>, AtomicQueueContext>>>(BENCH_NAME);
+    registry.add<ThroughputBenchmark<MsgType, MgarkBenchmarkContext, PRODUCER_N, CONSUMER_N,
+                                     MgarkSingleQueueProduceAll<ProduceIncremental<MsgType>, MgarkBenchmarkContext>,
+                                     MgarkSingleQueueNonBlockingConsumeAll<ConsumeAndStore<MsgType>, MgarkBenchmarkContext>>>(BENCH_NAME);
+  }
+}
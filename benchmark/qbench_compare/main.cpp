@@ -0,0 +1,160 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../framework/results_store.h"
+#include "../../framework/statistics.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static const char* USAGE =
+  "usage: qbench-compare [options] BASELINE CANDIDATE\n"
+  "  compares qbench --results files per benchmark key and exits with 1 if any benchmark\n"
+  "  regressed, 2 on errors\n"
+  "  --alpha P                   one-sided Mann-Whitney U significance level (default 0.01)\n"
+  "  --threshold PCT             ignore median changes smaller than PCT% (default 1)\n";
+
+struct CompareOptions
+{
+  double alpha{0.01};
+  double threshold_pct{1};
+  std::string baseline_path;
+  std::string candidate_path;
+};
+
+static CompareOptions parse_options(int argc, char** argv)
+{
+  CompareOptions opts;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--alpha" && i + 1 < argc)
+      opts.alpha = std::stod(argv[++i]);
+    else if (arg == "--threshold" && i + 1 < argc)
+      opts.threshold_pct = std::stod(argv[++i]);
+    else if (arg.rfind("--", 0) == 0)
+      throw std::runtime_error("invalid argument [" + arg + "]");
+    else
+      paths.push_back(arg);
+  }
+
+  if (paths.size() != 2)
+    throw std::runtime_error("expected BASELINE and CANDIDATE result files");
+
+  opts.baseline_path = paths[0];
+  opts.candidate_path = paths[1];
+  return opts;
+}
+
+int main(int argc, char** argv)
+{
+  try
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      if (std::string("--help") == argv[i])
+      {
+        std::cout << USAGE;
+        return 0;
+      }
+    }
+
+    CompareOptions opts = parse_options(argc, argv);
+    auto baseline = ResultsStore::load(opts.baseline_path);
+    auto candidate = ResultsStore::load(opts.candidate_path);
+
+    std::vector<std::string> keys;
+    for (const auto& b : baseline)
+      keys.push_back(b.first);
+    for (const auto& c : candidate)
+    {
+      if (!baseline.count(c.first))
+        keys.push_back(c.first);
+    }
+    std::sort(begin(keys), end(keys));
+
+    size_t regression_num = 0;
+    std::cout << "name,vendor,ring_buffer_sz,msg_type,placement,metric,baseline_n,candidate_n,"
+                 "baseline_median,candidate_median,change_pct,p_value,verdict,key\n";
+    for (const std::string& key : keys)
+    {
+      auto b = baseline.find(key);
+      auto c = candidate.find(key);
+      const ResultRecord& r = b != baseline.end() ? b->second : c->second;
+      std::cout << r.name << "," << r.vendor << "," << r.ring_buffer_sz << "," << r.msg_type << ","
+                << r.placement << "," << r.metric << ",";
+
+      if (b == baseline.end() || c == candidate.end() || b->second.samples.empty() ||
+          c->second.samples.empty())
+      {
+        std::cout << (b != baseline.end() ? b->second.samples.size() : 0) << ","
+                  << (c != candidate.end() ? c->second.samples.size() : 0) << ",,,,,"
+                  << (b == baseline.end() ? "new" : "missing") << "," << key << "\n";
+        continue;
+      }
+
+      const std::vector<double>& base_samples = b->second.samples;
+      const std::vector<double>& cand_samples = c->second.samples;
+      double base_median = median(base_samples);
+      double cand_median = median(cand_samples);
+      double change_pct = base_median != 0 ? 100.0 * (cand_median - base_median) / base_median : 0;
+
+      // a regression is the candidate being stochastically worse, the direction depends on the metric
+      MannWhitneyResult mw = mann_whitney_u(cand_samples, base_samples);
+      bool higher_is_better = b->second.higher_is_better;
+      double p_worse = higher_is_better ? mw.p_less : mw.p_greater;
+      double p_better = higher_is_better ? mw.p_greater : mw.p_less;
+      bool worse_enough = higher_is_better ? change_pct <= -opts.threshold_pct : change_pct >= opts.threshold_pct;
+      bool better_enough = higher_is_better ? change_pct >= opts.threshold_pct : change_pct <= -opts.threshold_pct;
+
+      const char* verdict = "same";
+      double p_value = std::min(p_worse, p_better);
+      if (p_worse < opts.alpha && worse_enough)
+      {
+        verdict = "REGRESSION";
+        p_value = p_worse;
+        ++regression_num;
+      }
+      else if (p_better < opts.alpha && better_enough)
+      {
+        verdict = "improvement";
+        p_value = p_better;
+      }
+
+      std::cout << base_samples.size() << "," << cand_samples.size() << "," << std::fixed
+                << std::setprecision(5) << base_median << "," << cand_median << ","
+                << std::setprecision(3) << change_pct << "," << std::setprecision(6) << p_value
+                << "," << verdict << "," << key << "\n";
+    }
+
+    if (regression_num != 0)
+    {
+      std::cerr << regression_num << " benchmark(s) regressed\n";
+      return 1;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "ERROR: " << e.what() << "\n" << USAGE;
+    return 2;
+  }
+
+  return 0;
+}
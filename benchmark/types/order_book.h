@@ -56,13 +56,27 @@ struct ProduceFreshOrderBook
   }
 
   T operator()()
+  {
+    next();
+    return val;
+  }
+
+  // same message, written straight into a queue slot
+  void operator()(T& slot)
+  {
+    next();
+    slot = val;
+  }
+
+private:
+  void next()
   {
     uint32_t new_seq_num = val.seq_num + 1;
+    val.seq_num = new_seq_num;
     val.bid_size[3] = new_seq_num;
     val.bid_size[17] = new_seq_num;
     val.ask_size[0] = new_seq_num;
     val.ask_size[19] = new_seq_num;
-    return val;
   }
 };
 
@@ -78,4 +92,32 @@ struct ConsumeAndStore<OrderBook>
     seq_num = last_val.seq_num;
     // ptr = reinterpret_cast<volatile OrderBook::seq_num_type*>(last_val.seq_num);
   }
-};
\ No newline at end of file
+};
+
+// Reads the first LEVEL_N levels of both sides right where the adapter hands the book over,
+// instead of copying the whole book like ConsumeAndStore does. Meant for adapters which peek, so
+// that it reads the queue slot itself, see the note in benchmark/qbench/throughput_grid_in_slot.cpp
+// on the vendors left out. Real handlers look at a few levels at most.
+template <class T, std::size_t LEVEL_N>
+struct ReadBookLevels
+{
+  static_assert(LEVEL_N >= 1 && LEVEL_N <= T::N);
+
+  volatile typename T::seq_num_type seq_num;
+  volatile uint64_t level_sum;
+
+  void operator()(const T& v)
+  {
+    uint64_t sum = 0;
+    for (std::size_t i = 0; i < LEVEL_N; ++i)
+      sum += uint64_t(v.bid_price[i]) * v.bid_size[i] + uint64_t(v.ask_price[i]) * v.ask_size[i];
+    level_sum = sum;
+    seq_num = v.seq_num;
+  }
+};
+
+template <class T>
+using ReadTopOfBook = ReadBookLevels<T, 1>;
+
+template <class T>
+using ScanFullBook = ReadBookLevels<T, T::N>;
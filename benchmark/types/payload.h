@@ -0,0 +1,77 @@
+
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed size message for message size scaling runs. Unlike OrderBook, producers write and
+// consumers read every cache line of it, so larger messages cost what they would cost a real feed
+// handler instead of being moved around untouched.
+template <std::size_t Bytes>
+struct Payload
+{
+  static_assert(Bytes >= sizeof(uint64_t) && Bytes % sizeof(uint64_t) == 0,
+                "payload size must be a non zero multiple of 8 bytes");
+
+  static constexpr std::size_t SIZE = Bytes;
+  static constexpr std::size_t WORD_N = Bytes / sizeof(uint64_t);
+  static constexpr std::size_t CACHE_LINE_WORD_N = 64 / sizeof(uint64_t);
+
+  std::array<uint64_t, WORD_N> words;
+
+  // Calls f with one word index per 64 bytes plus the last word. Consecutive indices are never
+  // more than a cache line apart, so every line the payload spans gets visited whatever its
+  // alignment within the queue slot is.
+  template <class F>
+  static void for_each_cache_line(F&& f)
+  {
+    for (std::size_t i = 0; i < WORD_N; i += CACHE_LINE_WORD_N)
+      f(i);
+    if ((WORD_N - 1) % CACHE_LINE_WORD_N != 0)
+      f(WORD_N - 1);
+  }
+};
+
+template <class T>
+struct ProducePayload
+{
+  T val{};
+  uint64_t seq_num{0};
+
+  T operator()()
+  {
+    ++seq_num;
+    T::for_each_cache_line([this](std::size_t i) { val.words[i] = seq_num; });
+    return val;
+  }
+};
+
+template <class T>
+struct ConsumePayload
+{
+  volatile uint64_t checksum{0};
+
+  void operator()(const T& v)
+  {
+    uint64_t sum = 0;
+    T::for_each_cache_line([&](std::size_t i) { sum += v.words[i]; });
+    checksum = sum;
+  }
+};
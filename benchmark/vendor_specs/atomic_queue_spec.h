@@ -17,49 +17,52 @@
 
 #pragma once
 
+#include "latency_histogram.h"
+#include "throughput_time_series.h"
+#include "tsc_clock.h"
+#include <algorithm>
 #include <atomic>
 #include <atomic_queue/atomic_queue.h>
 
-template <class T, T NIL_VAL, bool _MAXIMIZE_THROUGHPUT_>
+template <class T, T NIL_VAL, bool _MAXIMIZE_THROUGHPUT_, class Alloc = std::allocator<T>>
 struct AQ_SPSCBoundedDynamicContext
 {
   static constexpr const char* VENDOR = "atomic_queue";
 
-  using QueueType =
-    atomic_queue::AtomicQueueB<T, std::allocator<T>, NIL_VAL, _MAXIMIZE_THROUGHPUT_, false, true>;
+  using QueueType = atomic_queue::AtomicQueueB<T, Alloc, NIL_VAL, _MAXIMIZE_THROUGHPUT_, false, true>;
   QueueType q;
 
   AQ_SPSCBoundedDynamicContext(size_t ring_buffer_sz) : q(ring_buffer_sz) {}
 };
 
-template <class T, T NIL_VAL, bool _MAXIMIZE_THROUGHPUT_>
+template <class T, T NIL_VAL, bool _MAXIMIZE_THROUGHPUT_, class Alloc = std::allocator<T>>
 struct AQ_MPMCBoundedDynamicContext
 {
   static constexpr const char* VENDOR = "atomic_queue";
 
-  using QueueType = atomic_queue::AtomicQueueB<T, std::allocator<T>, NIL_VAL, _MAXIMIZE_THROUGHPUT_>;
+  using QueueType = atomic_queue::AtomicQueueB<T, Alloc, NIL_VAL, _MAXIMIZE_THROUGHPUT_>;
   QueueType q;
 
   AQ_MPMCBoundedDynamicContext(size_t ring_buffer_sz) : q(ring_buffer_sz) {}
 };
 
-template <class T, bool _MAXIMIZE_THROUGHPUT_>
+template <class T, bool _MAXIMIZE_THROUGHPUT_, class Alloc = std::allocator<T>>
 struct AQ_NonAtomic_SPSCBoundedDynamicContext
 {
   static constexpr const char* VENDOR = "atomic_queue";
 
-  using QueueType = atomic_queue::AtomicQueueB2<T, std::allocator<T>, _MAXIMIZE_THROUGHPUT_, false, true>;
+  using QueueType = atomic_queue::AtomicQueueB2<T, Alloc, _MAXIMIZE_THROUGHPUT_, false, true>;
   QueueType q;
 
   AQ_NonAtomic_SPSCBoundedDynamicContext(size_t ring_buffer_sz) : q(ring_buffer_sz) {}
 };
 
-template <class T, bool _MAXIMIZE_THROUGHPUT_>
+template <class T, bool _MAXIMIZE_THROUGHPUT_, class Alloc = std::allocator<T>>
 struct AQ_NonAtomic_MPMCBoundedDynamicContext
 {
   static constexpr const char* VENDOR = "atomic_queue";
 
-  using QueueType = atomic_queue::AtomicQueueB2<T, std::allocator<T>, _MAXIMIZE_THROUGHPUT_>;
+  using QueueType = atomic_queue::AtomicQueueB2<T, Alloc, _MAXIMIZE_THROUGHPUT_>;
   QueueType q;
 
   AQ_NonAtomic_MPMCBoundedDynamicContext(size_t ring_buffer_sz) : q(ring_buffer_sz) {}
@@ -95,10 +98,12 @@ struct AtomicQueueConsumeAll
   size_t N_;
   BenchmarkContext& ctx_;
   ProcessOneMessage& p_;
+  ProgressStamps& stamps_;
   using message_processor = ProcessOneMessage;
 
-  AtomicQueueConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p)
-    : N_(N), ctx_(ctx), p_(p)
+  AtomicQueueConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p,
+                        ProgressStamps& stamps = ProgressStamps::none())
+    : N_(N), ctx_(ctx), p_(p), stamps_(stamps)
   {
   }
 
@@ -107,8 +112,47 @@ struct AtomicQueueConsumeAll
     size_t i = 0;
     while (i < N_)
     {
+      // atomic_queue has no peek, so unlike other adapters the processor gets a copy of the slot
       p_(ctx_.q.pop());
-      ++i;
+      stamps_.on_consumed(++i);
+    }
+
+    return i;
+  }
+};
+
+// atomic_queue has no batch pop either: waits for one message, then takes whatever else is
+// already there, up to BATCH_N messages in total
+template <class ProcessOneMessage, class BenchmarkContext, size_t BATCH_N>
+struct AtomicQueueBatchConsumeAll
+{
+  size_t N_;
+  BenchmarkContext& ctx_;
+  ProcessOneMessage& p_;
+  ProgressStamps& stamps_;
+  using message_processor = ProcessOneMessage;
+
+  AtomicQueueBatchConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p,
+                             ProgressStamps& stamps = ProgressStamps::none())
+    : N_(N), ctx_(ctx), p_(p), stamps_(stamps)
+  {
+  }
+
+  size_t operator()()
+  {
+    size_t i = 0;
+    while (i < N_)
+    {
+      size_t batch_end = std::min(i + BATCH_N, N_);
+      p_(ctx_.q.pop());
+      stamps_.on_consumed(++i);
+
+      decltype(ctx_.q.pop()) v;
+      while (i < batch_end && ctx_.q.try_pop(v))
+      {
+        p_(v);
+        stamps_.on_consumed(++i);
+      }
     }
 
     return i;
@@ -128,20 +172,28 @@ struct AQLatencyA
 
   template <class BenchmarkContext>
   size_t operator()(size_t thread_idx, size_t N, BenchmarkContext& a_ctx, BenchmarkContext& b_ctx,
-                    ProduceOneMessage& mc, ProcessOneMessage& mp)
+                    ProduceOneMessage& mc, ProcessOneMessage& mp, LatencyHistogram& histogram)
   {
     int i = 0;
+    uint64_t start_tsc = 0;
     while (i <= N)
     {
       // if there are multiple producers, we just allow the first
       // one to publish the very first bootstrap message
-      if (i > 0 || thread_idx == 0)
+      bool published = i > 0 || thread_idx == 0;
+      if (published)
+      {
+        start_tsc = TscClock::rdtsc();
         a_ctx.q.push(mc());
+      }
 
       if (i == N)
         break;
 
       mp(b_ctx.q.pop());
+      if (published)
+        histogram.record(TscClock::rdtscp() - start_tsc);
+
       ++i;
     }
 
@@ -19,27 +19,37 @@
 
 #include "detail/common.h"
 #include "detail/consumer.h"
+#include "factory.h"
+#include "latency_histogram.h"
+#include "throughput_time_series.h"
+#include "tsc_clock.h"
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <memory>
 #include <mpmc.h>
 
-template <class T, size_t _PRODUCER_N_, size_t _CONSUMER_N_, size_t _BATCH_NUM_ = 4, size_t _CPU_PAUSE_N_ = 0>
+template <class T, size_t _PRODUCER_N_, size_t _CONSUMER_N_, size_t _BATCH_NUM_ = 4, size_t _CPU_PAUSE_N_ = 0,
+          class Alloc = std::allocator<T>>
 struct Mgark_MulticastReliableBoundedContext
 {
   static constexpr const char* VENDOR = "mgark";
 
-  using QueueType = SPMCMulticastQueueReliableBounded<T, _CONSUMER_N_, _PRODUCER_N_, _BATCH_NUM_, _CPU_PAUSE_N_>;
+  using QueueType =
+    SPMCMulticastQueueReliableBounded<T, _CONSUMER_N_, _PRODUCER_N_, _BATCH_NUM_, _CPU_PAUSE_N_, true, Alloc>;
   QueueType q;
 
   Mgark_MulticastReliableBoundedContext(size_t ring_buffer_sz) : q(ring_buffer_sz) {}
 };
 
-template <class T, size_t _PRODUCER_N_, size_t _CONSUMER_N_, size_t _BATCH_NUM_ = 4, size_t _CPU_PAUSE_N_ = 0>
+template <class T, size_t _PRODUCER_N_, size_t _CONSUMER_N_, size_t _BATCH_NUM_ = 4, size_t _CPU_PAUSE_N_ = 0,
+          class Alloc = std::allocator<T>>
 struct Mgark_AnycastReliableBoundedContext_SingleQueue
 {
   static constexpr const char* VENDOR = "mgark";
 
-  using QueueType = SPMCMulticastQueueReliableBounded<T, _CONSUMER_N_, _PRODUCER_N_, _BATCH_NUM_, _CPU_PAUSE_N_>;
+  using QueueType =
+    SPMCMulticastQueueReliableBounded<T, _CONSUMER_N_, _PRODUCER_N_, _BATCH_NUM_, _CPU_PAUSE_N_, true, Alloc>;
   QueueType q;
   AnycastConsumerGroup<QueueType> consumer_group;
 
@@ -49,14 +59,15 @@ struct Mgark_AnycastReliableBoundedContext_SingleQueue
   }
 };
 
-template <class T, size_t _PRODUCER_N_, size_t _CONSUMER_N_, size_t _BATCH_NUM_ = 4, size_t _CPU_PAUSE_N_ = 0>
+template <class T, size_t _PRODUCER_N_, size_t _CONSUMER_N_, size_t _BATCH_NUM_ = 4, size_t _CPU_PAUSE_N_ = 0,
+          class Alloc = std::allocator<T>>
 struct Mgark_Anycast2ReliableBoundedContext_SingleQueue
 {
   static constexpr const char* VENDOR = "mgark_anycast_optimized";
   static constexpr bool _MULTICAST_ = false;
 
   using QueueType =
-    SPMCMulticastQueueReliableBounded<T, _CONSUMER_N_, _PRODUCER_N_, _BATCH_NUM_, _CPU_PAUSE_N_, _MULTICAST_>;
+    SPMCMulticastQueueReliableBounded<T, _CONSUMER_N_, _PRODUCER_N_, _BATCH_NUM_, _CPU_PAUSE_N_, _MULTICAST_, Alloc>;
   QueueType q;
 
   Mgark_Anycast2ReliableBoundedContext_SingleQueue(size_t ring_buffer_sz) : q(ring_buffer_sz) {}
@@ -92,6 +103,38 @@ struct MgarkSingleQueueProduceAll
   }
 };
 
+// Creator writes every message straight into its slot. The producer can only placement-new
+// messages from emplace() arguments, so the queue has to carry InPlaceMessage<T>.
+template <class ProduceOneMessage, class BenchmarkContext>
+  requires InPlaceCreator<ProduceOneMessage, created_message_t<ProduceOneMessage>>
+struct MgarkSingleQueueInPlaceProduceAll
+{
+  size_t N_;
+  BenchmarkContext& ctx_;
+  ProduceOneMessage& message_creator_;
+  ProducerBlocking<typename BenchmarkContext::QueueType> p_;
+
+  using message_creator = ProduceOneMessage;
+  MgarkSingleQueueInPlaceProduceAll(size_t N, BenchmarkContext& ctx, ProduceOneMessage& message_creator)
+    : N_(N), ctx_(ctx), message_creator_(message_creator), p_(ctx.q)
+  {
+  }
+
+  size_t operator()()
+  {
+    size_t i = 0;
+    ProduceReturnCode ret_code;
+    while (i < N_)
+    {
+      ret_code = p_.emplace(InPlaceArgs<ProduceOneMessage>{message_creator_});
+      if (ProduceReturnCode::Published == ret_code)
+        ++i;
+    }
+
+    return i;
+  }
+};
+
 template <class ProcessOneMessage, class BenchmarkContext>
 struct MgarkSingleQueueConsumeAll
 {
@@ -136,10 +179,12 @@ struct MgarkSingleQueueNonBlockingConsumeAll
   ProcessOneMessage& p_;
   using QueueType = typename BenchmarkContext::QueueType;
   ConsumerNonBlocking<QueueType> c_;
+  ProgressStamps& stamps_;
 
   using message_processor = ProcessOneMessage;
-  MgarkSingleQueueNonBlockingConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p)
-    : N_(N), ctx_(ctx), p_(p), c_(ctx_.q)
+  MgarkSingleQueueNonBlockingConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p,
+                                        ProgressStamps& stamps = ProgressStamps::none())
+    : N_(N), ctx_(ctx), p_(p), c_(ctx_.q), stamps_(stamps)
   {
   }
 
@@ -155,7 +200,8 @@ struct MgarkSingleQueueNonBlockingConsumeAll
       while (it != c_.cend() && !stop)
       {
         p_(*it);
-        if (++i == N_)
+        stamps_.on_consumed(++i);
+        if (i == N_)
           stop = true;
         else
           ++it;
@@ -168,6 +214,49 @@ struct MgarkSingleQueueNonBlockingConsumeAll
   }
 };
 
+// mgark has no batch consume, so it drains at most BATCH_N messages in a row and then pauses
+// like MgarkSingleQueueNonBlockingConsumeAll does after every range
+template <class ProcessOneMessage, class BenchmarkContext, size_t BATCH_N>
+struct MgarkSingleQueueBatchConsumeAll
+{
+  size_t N_;
+  BenchmarkContext& ctx_;
+  ProcessOneMessage& p_;
+  using QueueType = typename BenchmarkContext::QueueType;
+  ConsumerNonBlocking<QueueType> c_;
+  ProgressStamps& stamps_;
+
+  using message_processor = ProcessOneMessage;
+  MgarkSingleQueueBatchConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p,
+                                  ProgressStamps& stamps = ProgressStamps::none())
+    : N_(N), ctx_(ctx), p_(p), c_(ctx_.q), stamps_(stamps)
+  {
+  }
+
+  size_t operator()()
+  {
+    size_t i = 0;
+    while (i < N_)
+    {
+      size_t batch_end = std::min(i + BATCH_N, N_);
+      while (i < batch_end)
+      {
+        auto* v = c_.peek();
+        if (!v)
+          break;
+
+        p_(*v);
+        c_.skip();
+        stamps_.on_consumed(++i);
+      }
+
+      unroll<QueueType::CPU_PAUSE_N>([]() { _mm_pause(); });
+    }
+
+    return i;
+  }
+};
+
 /*template <class ProcessOneMessage, class BenchmarkContext>
 struct MgarkSingleQueueAnycastConsumeAll
 {
@@ -212,7 +301,7 @@ struct MgarkSingleQueueLatencyA
   MgarkSingleQueueLatencyA(BenchmarkContext& a_ctx, BenchmarkContext& b_ctx) : consumer(b_ctx.q) {}
 
   size_t operator()(size_t thread_idx, size_t N, BenchmarkContext& a_ctx, BenchmarkContext& b_ctx,
-                    ProduceOneMessage& mc, ProcessOneMessage& mp)
+                    ProduceOneMessage& mc, ProcessOneMessage& mp, LatencyHistogram& histogram)
   {
     // important to do this after creating a consumer since it needs first to join the queue before
     // a_ctx.q.start();
@@ -224,12 +313,15 @@ struct MgarkSingleQueueLatencyA
     ProduceReturnCode p_ret_code;
     ConsumeReturnCode c_ret_code;
 
+    uint64_t start_tsc = 0;
     while (i <= N)
     {
       // if there are multiple producers, we just allow the first
       // one to publish the very first bootstrap message
-      if (i > 0 || thread_idx == 0)
+      bool published = i > 0 || thread_idx == 0;
+      if (published)
       {
+        start_tsc = TscClock::rdtsc();
         p_ret_code = producer.emplace(mc());
       }
 
@@ -247,6 +339,9 @@ struct MgarkSingleQueueLatencyA
         }
       }
 
+      if (published)
+        histogram.record(TscClock::rdtscp() - start_tsc);
+
       ++i;
     }
 
@@ -1,4 +1,7 @@
 #include "detail/common.h"
+#include "factory.h"
+#include "throughput_time_series.h"
+#include <algorithm>
 #include <assert.h>
 #include <atomic>
 #include <chrono>
@@ -9,11 +12,12 @@
 
 #include <new>
 #include <stdexcept>
+#include <string>
 #include <thread>
 #include <type_traits>
 #include <x86intrin.h>
 
-template <class T>
+template <class T, class Alloc = std::allocator<T>>
 class SPSC1
 {
   struct Node
@@ -28,7 +32,7 @@ class SPSC1
   Node* data_;
   alignas(64) size_t read_idx_{0};
   alignas(64) size_t write_idx_{0};
-  std::allocator<Node> alloc_;
+  typename std::allocator_traits<Alloc>::template rebind_alloc<Node> alloc_;
   size_t N_;
 
 public:
@@ -72,14 +76,79 @@ public:
     write_idx_ = (write_idx_ + 1) & (N_ - 1);
     node->busy.store(true, std::memory_order_release);
   }
+
+  // the message is written straight into its slot: fill gets a default-initialized T
+  template <class Fill>
+  void emplace_with(Fill&& fill)
+  {
+    Node* node = &data_[write_idx_];
+    while (node->busy.load(std::memory_order_acquire))
+      ;
+
+    fill(*::new (node->paylod) T);
+    write_idx_ = (write_idx_ + 1) & (N_ - 1);
+    node->busy.store(true, std::memory_order_release);
+  }
+
+  // the biggest batch emplace_n() accepts
+  size_t max_batch_n() const { return N_; }
+
+  // Writes n <= max_batch_n() messages straight into their slots, fill gets every
+  // default-initialized T in turn. The slots are only handed over to the consumer once the whole
+  // batch is written.
+  template <class Fill>
+  void emplace_n(size_t n, Fill&& fill)
+  {
+    assert(n <= max_batch_n());
+
+    // the consumer frees slots in order, so once the last one is free all of them are
+    Node* last = &data_[(write_idx_ + n - 1) & (N_ - 1)];
+    while (last->busy.load(std::memory_order_acquire))
+      ;
+
+    for (size_t i = 0; i < n; ++i)
+      fill(*::new (data_[(write_idx_ + i) & (N_ - 1)].paylod) T);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+      data_[write_idx_].busy.store(true, std::memory_order_release);
+      write_idx_ = (write_idx_ + 1) & (N_ - 1);
+    }
+  }
+
+  // Calls f for up to max_n messages in their slots and frees the slots afterwards, returns how
+  // many messages were consumed, 0 if the queue was empty. Does not wait for messages.
+  template <class F>
+  size_t consume_n(size_t max_n, F&& f)
+  {
+    max_n = std::min(max_n, N_); // past that the scan would come back to the first slot
+    size_t n = 0;
+    while (n < max_n)
+    {
+      Node* node = &data_[(read_idx_ + n) & (N_ - 1)];
+      if (!node->busy.load(std::memory_order_acquire))
+        break;
+
+      f(*std::launder(reinterpret_cast<const T*>(node->paylod)));
+      ++n;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+      data_[read_idx_].busy.store(false, std::memory_order_release);
+      read_idx_ = (read_idx_ + 1) & (N_ - 1);
+    }
+
+    return n;
+  }
 };
 
-template <class T>
+template <class T, class Alloc = std::allocator<T>>
 struct Spsc1BenchmarkContext
 {
   static constexpr const char* VENDOR = "spsc1";
 
-  using QueueType = SPSC1<T>;
+  using QueueType = SPSC1<T, Alloc>;
   QueueType q;
 
   Spsc1BenchmarkContext(size_t ring_buffer_sz) : q(ring_buffer_sz) {}
@@ -111,16 +180,84 @@ struct Spsc1SingleQueueProduceAll
   }
 };
 
+// creator writes every message straight into its slot
+template <class ProduceOneMessage, class BenchmarkContext>
+  requires InPlaceCreator<ProduceOneMessage, created_message_t<ProduceOneMessage>>
+struct Spsc1SingleQueueInPlaceProduceAll
+{
+  size_t N_;
+  BenchmarkContext& ctx_;
+  ProduceOneMessage& message_creator_;
+
+  using message_creator = ProduceOneMessage;
+  Spsc1SingleQueueInPlaceProduceAll(size_t N, BenchmarkContext& ctx, ProduceOneMessage& message_creator)
+    : N_(N), ctx_(ctx), message_creator_(message_creator)
+  {
+  }
+
+  size_t operator()()
+  {
+    size_t i = 0;
+    while (i < N_)
+    {
+      ctx_.q.emplace_with(message_creator_);
+      ++i;
+    }
+
+    return i;
+  }
+};
+
+// creator fills BATCH_N slots at a time, which are published together, see SPSC1::emplace_n
+template <class ProduceOneMessage, class BenchmarkContext, size_t BATCH_N>
+struct Spsc1BatchProduceAll
+{
+  size_t N_;
+  BenchmarkContext& ctx_;
+  ProduceOneMessage& message_creator_;
+
+  using message_creator = ProduceOneMessage;
+  Spsc1BatchProduceAll(size_t N, BenchmarkContext& ctx, ProduceOneMessage& message_creator)
+    : N_(N), ctx_(ctx), message_creator_(message_creator)
+  {
+  }
+
+  // called by the benchmark on construction, so that a batch which can never be written fails
+  // before any thread is started rather than in the middle of the measured loop
+  static void validate(const BenchmarkContext& ctx)
+  {
+    if (BATCH_N > ctx.q.max_batch_n())
+      throw std::runtime_error("batch of " + std::to_string(BATCH_N) +
+                               " does not fit a queue taking batches of up to " +
+                               std::to_string(ctx.q.max_batch_n()));
+  }
+
+  size_t operator()()
+  {
+    size_t i = 0;
+    while (i < N_)
+    {
+      size_t n = std::min(BATCH_N, N_ - i);
+      ctx_.q.emplace_n(n, [this](auto& slot) { slot = message_creator_(); });
+      i += n;
+    }
+
+    return i;
+  }
+};
+
 template <class ProcessOneMessage, class BenchmarkContext>
 struct Spsc1QueueConsumeAll
 {
   size_t N_;
   BenchmarkContext& ctx_;
   ProcessOneMessage& p_;
+  ProgressStamps& stamps_;
 
   using message_processor = ProcessOneMessage;
-  Spsc1QueueConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p)
-    : N_(N), ctx_(ctx), p_(p)
+  Spsc1QueueConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p,
+                       ProgressStamps& stamps = ProgressStamps::none())
+    : N_(N), ctx_(ctx), p_(p), stamps_(stamps)
   {
   }
 
@@ -134,10 +271,43 @@ struct Spsc1QueueConsumeAll
       {
         p_(*v);
         ctx_.q.skip();
-        ++i;
+        stamps_.on_consumed(++i);
       }
     }
 
     return i;
   }
 };
+
+// drains up to BATCH_N messages at a time, see SPSC1::consume_n
+template <class ProcessOneMessage, class BenchmarkContext, size_t BATCH_N>
+struct Spsc1BatchConsumeAll
+{
+  size_t N_;
+  BenchmarkContext& ctx_;
+  ProcessOneMessage& p_;
+  ProgressStamps& stamps_;
+
+  using message_processor = ProcessOneMessage;
+  Spsc1BatchConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p,
+                       ProgressStamps& stamps = ProgressStamps::none())
+    : N_(N), ctx_(ctx), p_(p), stamps_(stamps)
+  {
+  }
+
+  size_t operator()()
+  {
+    size_t i = 0;
+    while (i < N_)
+    {
+      ctx_.q.consume_n(std::min(BATCH_N, N_ - i),
+                       [this, &i](const auto& v)
+                       {
+                         p_(v);
+                         stamps_.on_consumed(++i);
+                       });
+    }
+
+    return i;
+  }
+};
@@ -1,4 +1,7 @@
 #include "detail/common.h"
+#include "factory.h"
+#include "throughput_time_series.h"
+#include <algorithm>
 #include <assert.h>
 #include <atomic>
 #include <chrono>
@@ -11,11 +14,12 @@
 #include "../../thirdparty/mgark/test/common_test_utils.h"
 #include <new>
 #include <stdexcept>
+#include <string>
 #include <thread>
 #include <type_traits>
 #include <x86intrin.h>
 
-template <class T, size_t BATCH_NUM = 4>
+template <class T, size_t BATCH_NUM = 4, class Alloc = std::allocator<T>>
 class SPSC2
 {
   struct Node
@@ -37,7 +41,7 @@ class SPSC2
   alignas(_CACHE_PREFETCH_SIZE_) size_t local_read_idx_{0};
   size_t next_checkpoint_idx_;
   size_t last_write_idx_{0};
-  std::allocator<Node> alloc_;
+  typename std::allocator_traits<Alloc>::template rebind_alloc<Node> alloc_;
 
   static constexpr size_t _batch_buffer_size_ = 256 / sizeof(Node);
   static constexpr size_t _items_per_cache_prefetch_num_ = _CACHE_PREFETCH_SIZE_ / sizeof(Node);
@@ -84,7 +88,10 @@ public:
     }
 
     size_t items_ready_num = last_write_idx_ - local_read_idx_;
-    if (items_ready_num >= _batch_buffer_size_)
+    // the batch must not wrap around the end of the ring, otherwise it would copy past data_.
+    // Messages above 256 bytes do not batch at all, there would be no room to copy them to.
+    if (_batch_buffer_size_ != 0 && items_ready_num >= _batch_buffer_size_ &&
+        (local_read_idx_ & (N_ - 1)) + _batch_buffer_size_ <= N_)
     {
       std::memcpy(&batch_buffer_, &data_[(local_read_idx_ & (N_ - 1))], _batch_buffer_size_ * sizeof(Node));
       // local_read_idx_ += _batch_buffer_size_;
@@ -109,12 +116,76 @@ public:
     }
   }
 
+  // Calls f for up to max_n messages in their slots, returns how many messages were consumed, 0
+  // if the queue was empty. Does not wait for messages and must not be mixed with peek()/skip().
+  template <class F>
+  size_t consume_n(size_t max_n, F&& f)
+  {
+    if (last_write_idx_ <= local_read_idx_)
+    {
+      last_write_idx_ = write_idx_.load(std::memory_order_acquire);
+      if (last_write_idx_ <= local_read_idx_)
+        return 0;
+    }
+
+    size_t n = std::min(max_n, last_write_idx_ - local_read_idx_);
+    for (size_t i = 0; i < n; ++i)
+      f(*std::launder(reinterpret_cast<const T*>(data_[(local_read_idx_ + i) & (N_ - 1)].paylod)));
+
+    local_read_idx_ += n;
+    if (local_read_idx_ > next_checkpoint_idx_)
+    {
+      read_idx_.store(local_read_idx_, std::memory_order_release);
+      while (next_checkpoint_idx_ < local_read_idx_)
+        next_checkpoint_idx_ += items_per_batch_;
+    }
+
+    return n;
+  }
+
   template <class... Args>
   void emplace(Args&&... args)
+  {
+    size_t write_idx = wait_for_slot();
+    Node* node = &data_[write_idx & (N_ - 1)];
+    ::new (node->paylod) T(std::forward<Args>(args)...);
+    write_idx_.store(write_idx + 1, std::memory_order_release);
+  }
+
+  // the message is written straight into its slot: fill gets a default-initialized T
+  template <class Fill>
+  void emplace_with(Fill&& fill)
+  {
+    size_t write_idx = wait_for_slot();
+    Node* node = &data_[write_idx & (N_ - 1)];
+    fill(*::new (node->paylod) T);
+    write_idx_.store(write_idx + 1, std::memory_order_release);
+  }
+
+  // the biggest batch emplace_n() accepts, the consumer only hands slots back at checkpoints so a
+  // bigger batch could wait forever
+  size_t max_batch_n() const { return N_ - items_per_batch_; }
+
+  // Writes n <= max_batch_n() messages straight into their slots, fill gets every
+  // default-initialized T in turn. The whole batch is published with a single store.
+  template <class Fill>
+  void emplace_n(size_t n, Fill&& fill)
+  {
+    assert(n <= max_batch_n());
+
+    size_t write_idx = wait_for_slot(n);
+    for (size_t i = 0; i < n; ++i)
+      fill(*::new (data_[(write_idx + i) & (N_ - 1)].paylod) T);
+    write_idx_.store(write_idx + n, std::memory_order_release);
+  }
+
+private:
+  // spins until the consumer has freed the next n slots, returns the write index of the first one
+  size_t wait_for_slot(size_t n = 1)
   {
     bool first_time = true;
     size_t write_idx = write_idx_.load(std::memory_order_relaxed);
-    while (write_idx >= last_read_idx_ + N_)
+    while (write_idx + n > last_read_idx_ + N_)
     {
       last_read_idx_ = read_idx_.load(std::memory_order_acquire);
       if (first_time == false)
@@ -125,18 +196,16 @@ public:
       first_time = false;
     }
 
-    Node* node = &data_[write_idx & (N_ - 1)];
-    ::new (node->paylod) T(std::forward<Args>(args)...);
-    write_idx_.store(write_idx + 1, std::memory_order_release);
+    return write_idx;
   }
 };
 
-template <class T, size_t BATCH_NUM>
+template <class T, size_t BATCH_NUM, class Alloc = std::allocator<T>>
 struct Spsc2BenchmarkContext
 {
   static constexpr const char* VENDOR = "spsc2";
 
-  using QueueType = SPSC2<T, BATCH_NUM>;
+  using QueueType = SPSC2<T, BATCH_NUM, Alloc>;
   QueueType q;
 
   Spsc2BenchmarkContext(size_t ring_buffer_sz) : q(ring_buffer_sz) {}
@@ -168,16 +237,46 @@ struct Spsc2SingleQueueProduceAll
   }
 };
 
+// creator writes every message straight into its slot
+template <class ProduceOneMessage, class BenchmarkContext>
+  requires InPlaceCreator<ProduceOneMessage, created_message_t<ProduceOneMessage>>
+struct Spsc2SingleQueueInPlaceProduceAll
+{
+  size_t N_;
+  BenchmarkContext& ctx_;
+  ProduceOneMessage& message_creator_;
+
+  using message_creator = ProduceOneMessage;
+  Spsc2SingleQueueInPlaceProduceAll(size_t N, BenchmarkContext& ctx, ProduceOneMessage& message_creator)
+    : N_(N), ctx_(ctx), message_creator_(message_creator)
+  {
+  }
+
+  size_t operator()()
+  {
+    size_t i = 0;
+    while (i < N_)
+    {
+      ctx_.q.emplace_with(message_creator_);
+      ++i;
+    }
+
+    return i;
+  }
+};
+
 template <class ProcessOneMessage, class BenchmarkContext>
 struct Spsc2QueueConsumeAll
 {
   size_t N_;
   BenchmarkContext& ctx_;
   ProcessOneMessage& p_;
+  ProgressStamps& stamps_;
 
   using message_processor = ProcessOneMessage;
-  Spsc2QueueConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p)
-    : N_(N), ctx_(ctx), p_(p)
+  Spsc2QueueConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p,
+                       ProgressStamps& stamps = ProgressStamps::none())
+    : N_(N), ctx_(ctx), p_(p), stamps_(stamps)
   {
   }
 
@@ -191,10 +290,81 @@ struct Spsc2QueueConsumeAll
       {
         p_(*v);
         ctx_.q.skip();
-        ++i;
+        stamps_.on_consumed(++i);
       }
     }
 
     return i;
   }
 };
+
+// creator fills BATCH_N slots at a time, which are published together, see SPSC2::emplace_n
+template <class ProduceOneMessage, class BenchmarkContext, size_t BATCH_N>
+struct Spsc2BatchProduceAll
+{
+  size_t N_;
+  BenchmarkContext& ctx_;
+  ProduceOneMessage& message_creator_;
+
+  using message_creator = ProduceOneMessage;
+  Spsc2BatchProduceAll(size_t N, BenchmarkContext& ctx, ProduceOneMessage& message_creator)
+    : N_(N), ctx_(ctx), message_creator_(message_creator)
+  {
+  }
+
+  // called by the benchmark on construction, so that a batch which can never be written fails
+  // before any thread is started rather than in the middle of the measured loop
+  static void validate(const BenchmarkContext& ctx)
+  {
+    if (BATCH_N > ctx.q.max_batch_n())
+      throw std::runtime_error("batch of " + std::to_string(BATCH_N) +
+                               " does not fit a queue taking batches of up to " +
+                               std::to_string(ctx.q.max_batch_n()));
+  }
+
+  size_t operator()()
+  {
+    size_t i = 0;
+    while (i < N_)
+    {
+      size_t n = std::min(BATCH_N, N_ - i);
+      ctx_.q.emplace_n(n, [this](auto& slot) { slot = message_creator_(); });
+      i += n;
+    }
+
+    return i;
+  }
+};
+
+// drains up to BATCH_N messages at a time, see SPSC2::consume_n
+template <class ProcessOneMessage, class BenchmarkContext, size_t BATCH_N>
+struct Spsc2BatchConsumeAll
+{
+  size_t N_;
+  BenchmarkContext& ctx_;
+  ProcessOneMessage& p_;
+  ProgressStamps& stamps_;
+
+  using message_processor = ProcessOneMessage;
+  Spsc2BatchConsumeAll(size_t N, BenchmarkContext& ctx, ProcessOneMessage& p,
+                       ProgressStamps& stamps = ProgressStamps::none())
+    : N_(N), ctx_(ctx), p_(p), stamps_(stamps)
+  {
+  }
+
+  size_t operator()()
+  {
+    size_t i = 0;
+    while (i < N_)
+    {
+      ctx_.q.consume_n(std::min(BATCH_N, N_ - i),
+                       [this, &i](const auto& v)
+                       {
+                         p_(v);
+                         stamps_.on_consumed(++i);
+                       });
+    }
+
+    return i;
+  }
+};
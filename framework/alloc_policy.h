@@ -0,0 +1,281 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "memory_footprint.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+// How queue storage is backed: page size, NUMA node and whether it is faulted in before the run.
+struct AllocationPolicy
+{
+  enum class Pages
+  {
+    Default,         // operator new, i.e. whatever malloc does
+    TransparentHuge, // 2MB aligned mmap with madvise(MADV_HUGEPAGE)
+    HugeTlb          // mmap(MAP_HUGETLB), needs vm.nr_hugepages to be reserved
+  };
+
+  static constexpr size_t HUGE_PAGE_SZ = 2 * 1024 * 1024;
+
+  Pages pages{Pages::Default};
+  int numa_node{-1}; // mbind the storage to it, -1 leaves it to the first touch
+  bool prefault{false};
+
+  bool is_default() const { return pages == Pages::Default && numa_node < 0 && !prefault; }
+
+  // page kind followed by optional modifiers, e.g. default, thp, hugetlb+node1+prefault
+  static AllocationPolicy parse(const std::string& s)
+  {
+    AllocationPolicy p;
+    std::stringstream ss(s);
+    std::string token;
+    bool first = true;
+    while (std::getline(ss, token, '+'))
+    {
+      if (first && token == "default")
+        p.pages = Pages::Default;
+      else if (first && token == "thp")
+        p.pages = Pages::TransparentHuge;
+      else if (first && token == "hugetlb")
+        p.pages = Pages::HugeTlb;
+      else if (!first && token == "prefault")
+        p.prefault = true;
+      else if (!first && token.rfind("node", 0) == 0 && token.size() > 4)
+        p.numa_node = std::stoi(token.substr(4));
+      else
+        throw std::runtime_error("invalid allocation policy [" + s +
+                                 "], expected default|thp|hugetlb[+nodeN][+prefault]");
+      first = false;
+    }
+
+    if (p.numa_node >= 64)
+      throw std::runtime_error("NUMA nodes above 63 are not supported");
+    return p;
+  }
+
+  std::string to_string() const
+  {
+    std::string s = pages == Pages::TransparentHuge ? "thp" : pages == Pages::HugeTlb ? "hugetlb" : "default";
+    if (numa_node >= 0)
+      s += "+node" + std::to_string(numa_node);
+    if (prefault)
+      s += "+prefault";
+    return s;
+  }
+
+  friend bool operator==(const AllocationPolicy& l, const AllocationPolicy& r)
+  {
+    return l.pages == r.pages && l.numa_node == r.numa_node && l.prefault == r.prefault;
+  }
+};
+
+inline std::vector<AllocationPolicy> parse_allocation_policies(const std::string& list)
+{
+  std::vector<AllocationPolicy> result;
+  std::stringstream ss(list);
+  std::string policy;
+  while (std::getline(ss, policy, ','))
+    result.push_back(AllocationPolicy::parse(policy));
+  return result;
+}
+
+namespace detail
+{
+inline size_t policy_mapping_sz(size_t bytes, const AllocationPolicy& policy)
+{
+  size_t page_sz = policy.pages == AllocationPolicy::Pages::Default ? sysconf(_SC_PAGESIZE)
+                                                                     : AllocationPolicy::HUGE_PAGE_SZ;
+  return (bytes + page_sz - 1) / page_sz * page_sz;
+}
+
+inline void throw_errno(const std::string& what, const std::string& hint = "")
+{
+  throw std::runtime_error(what + " failed: " + std::strerror(errno) + hint);
+}
+} // namespace detail
+
+// Default policies go through operator new, anything else is mmap-ed so that the page size and
+// the NUMA binding are under control. Memory is bound before it is touched for the first time.
+inline void* policy_allocate(size_t bytes, size_t alignment, const AllocationPolicy& policy)
+{
+  if (policy.is_default())
+    return ::operator new(bytes, std::align_val_t(alignment));
+
+  size_t sz = detail::policy_mapping_sz(bytes, policy);
+  void* p = nullptr;
+  if (policy.pages == AllocationPolicy::Pages::HugeTlb)
+  {
+    p = mmap(nullptr, sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED)
+      detail::throw_errno("mmap(MAP_HUGETLB) of " + std::to_string(sz) + " bytes",
+                          ", are enough huge pages reserved in vm.nr_hugepages?");
+  }
+  else if (policy.pages == AllocationPolicy::Pages::TransparentHuge)
+  {
+    // over-map so that the storage can start at a huge page boundary, the rest is given back
+    size_t mapped_sz = sz + AllocationPolicy::HUGE_PAGE_SZ;
+    void* m = mmap(nullptr, mapped_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED)
+      detail::throw_errno("mmap");
+
+    uintptr_t begin = reinterpret_cast<uintptr_t>(m);
+    uintptr_t aligned = (begin + AllocationPolicy::HUGE_PAGE_SZ - 1) & ~(AllocationPolicy::HUGE_PAGE_SZ - 1);
+    if (aligned != begin)
+      munmap(m, aligned - begin);
+    if (size_t tail = begin + mapped_sz - (aligned + sz))
+      munmap(reinterpret_cast<void*>(aligned + sz), tail);
+
+    p = reinterpret_cast<void*>(aligned);
+    if (madvise(p, sz, MADV_HUGEPAGE) != 0)
+    {
+      munmap(p, sz);
+      detail::throw_errno("madvise(MADV_HUGEPAGE)");
+    }
+  }
+  else
+  {
+    p = mmap(nullptr, sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+      detail::throw_errno("mmap");
+  }
+
+  if (policy.numa_node >= 0)
+  {
+    constexpr int MPOL_BIND_MODE = 2; // MPOL_BIND from numaif.h, which needs libnuma headers
+    unsigned long nodemask = 1UL << policy.numa_node;
+    // the kernel reads one bit less than maxnode, so it has to cover node 63 as well
+    if (syscall(SYS_mbind, p, sz, MPOL_BIND_MODE, &nodemask, sizeof(nodemask) * 8 + 1, 0) != 0)
+    {
+      munmap(p, sz);
+      detail::throw_errno("mbind to NUMA node " + std::to_string(policy.numa_node));
+    }
+  }
+
+  AllocationCounter::on_alloc(sz); // bypasses operator new, but is part of the context footprint
+  if (policy.prefault)
+  {
+    size_t page_sz = sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < sz; offset += page_sz)
+      static_cast<volatile char*>(p)[offset] = 0;
+  }
+
+  return p;
+}
+
+inline void policy_deallocate(void* p, size_t bytes, size_t alignment, const AllocationPolicy& policy)
+{
+  if (policy.is_default())
+    ::operator delete(p, std::align_val_t(alignment));
+  else
+    munmap(p, detail::policy_mapping_sz(bytes, policy));
+}
+
+// Policy new PolicyAllocators pick up on the current thread. Benchmarks hold one while their
+// contexts get constructed, so queues templated on PolicyAllocator do not need to know about it.
+class AllocationPolicyScope
+{
+  static AllocationPolicy& current_policy()
+  {
+    static thread_local AllocationPolicy policy;
+    return policy;
+  }
+
+  static size_t& allocation_num()
+  {
+    static thread_local size_t num{0};
+    return num;
+  }
+
+  AllocationPolicy prev_;
+  size_t start_allocation_num_;
+  bool active_{true};
+
+public:
+  explicit AllocationPolicyScope(const AllocationPolicy& policy)
+    : prev_(current_policy()), start_allocation_num_(allocation_num())
+  {
+    current_policy() = policy;
+  }
+
+  ~AllocationPolicyScope() { end(); }
+
+  AllocationPolicyScope(const AllocationPolicyScope&) = delete;
+  AllocationPolicyScope& operator=(const AllocationPolicyScope&) = delete;
+
+  // restores the previous policy, returns whether any PolicyAllocator allocated within the scope
+  bool end()
+  {
+    if (active_)
+    {
+      current_policy() = prev_;
+      active_ = false;
+    }
+
+    return allocation_num() != start_allocation_num_;
+  }
+
+  static const AllocationPolicy& current() { return current_policy(); }
+  static void on_allocate() { ++allocation_num(); }
+};
+
+// Stateful allocator which remembers the policy it was created under, so that memory is given back
+// the same way it was obtained even if the policy in scope has changed since.
+template <class T>
+class PolicyAllocator
+{
+  template <class U>
+  friend class PolicyAllocator;
+
+  AllocationPolicy policy_;
+
+public:
+  using value_type = T;
+
+  PolicyAllocator() : policy_(AllocationPolicyScope::current()) {}
+  explicit PolicyAllocator(const AllocationPolicy& policy) : policy_(policy) {}
+
+  template <class U>
+  PolicyAllocator(const PolicyAllocator<U>& other) : policy_(other.policy_)
+  {
+  }
+
+  T* allocate(size_t n)
+  {
+    AllocationPolicyScope::on_allocate();
+    return static_cast<T*>(policy_allocate(n * sizeof(T), alignof(T), policy_));
+  }
+
+  void deallocate(T* p, size_t n) { policy_deallocate(p, n * sizeof(T), alignof(T), policy_); }
+
+  const AllocationPolicy& policy() const { return policy_; }
+
+  template <class U>
+  friend bool operator==(const PolicyAllocator& l, const PolicyAllocator<U>& r)
+  {
+    return l.policy_ == r.policy_;
+  }
+};
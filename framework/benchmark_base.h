@@ -16,6 +16,11 @@
 
 #pragma once
 
+#include "alloc_policy.h"
+#include "cpu_topology.h"
+#include "memory_footprint.h"
+#include "warmup.h"
+#include "worker_pool.h"
 #include <atomic>
 #include <chrono>
 #include <deque>
@@ -33,25 +38,65 @@
 #include <list>
 #include <random>
 
+// everything which can be decided at runtime for a single benchmark instance
+struct BenchmarkParams
+{
+  size_t ring_buffer_sz;
+  PlacementScenario placement;
+  double msg_per_second{0}; // publish rate for paced benchmarks, 0 means as fast as possible
+  size_t progress_stamp_every{1024}; // messages per throughput time series window, 0 disables it
+  WarmupPolicy warmup;
+  AllocationPolicy alloc; // backing of the ring buffers of queues templated on PolicyAllocator
+
+  // alloc with the NUMA node of the placement, if the placement binds memory at all
+  AllocationPolicy context_alloc() const
+  {
+    AllocationPolicy result = alloc;
+    if (placement.memory_node >= 0)
+      result.numa_node = placement.memory_node;
+    return result;
+  }
+};
+
 template <class SingleRunResult>
 class BenchmarkBase
 {
   std::string name_;
   std::string vendor_;
   size_t ring_buffer_sz_;
+  std::string placement_;
+  std::string alloc_policy_{"default"};
   std::string key_;
+  MemoryFootprint memory_footprint_;
+
+  WorkerPool* worker_pool_{nullptr};
+  std::unique_ptr<WorkerPool> own_worker_pool_; // when the benchmark is run outside of a suite
+
+  WorkerPool& worker_pool()
+  {
+    if (worker_pool_ == nullptr)
+    {
+      own_worker_pool_ = std::make_unique<WorkerPool>();
+      worker_pool_ = own_worker_pool_.get();
+    }
+
+    return *worker_pool_;
+  }
 
   std::string make_hidden_unique_key() const
   {
     return name_ + vendor_ + std::to_string(ring_buffer_sz_) + "-" + msg_type_name() +
-      std::to_string(producer_num()) + "-" + std::to_string(consumer_num());
+      std::to_string(producer_num()) + "-" + std::to_string(consumer_num()) + "-" +
+      placement_ + "-" + format_core_list(producer_cores()) + "-" + format_core_list(consumer_cores()) +
+      (alloc_policy_ == "default" ? "" : "-" + alloc_policy_);
   }
 
 public:
   using single_run_result = SingleRunResult;
 
-  BenchmarkBase(const std::string& name, const std::string& vendor, size_t ring_buffer_sz)
-    : name_(name), vendor_(vendor), ring_buffer_sz_(ring_buffer_sz)
+  BenchmarkBase(const std::string& name, const std::string& vendor, size_t ring_buffer_sz,
+                const std::string& placement = "")
+    : name_(name), vendor_(vendor), ring_buffer_sz_(ring_buffer_sz), placement_(placement)
   {
   }
 
@@ -59,11 +104,69 @@ public:
 
   virtual SingleRunResult go(size_t N) = 0;
   virtual std::string msg_type_name() const = 0;
+  virtual size_t msg_size() const = 0; // bytes of a single message
   virtual size_t producer_num() const = 0;
   virtual size_t consumer_num() const = 0;
 
+  // cores the threads get pinned to, empty if threads are not pinned at all
+  virtual std::vector<size_t> producer_cores() const = 0;
+  virtual std::vector<size_t> consumer_cores() const = 0;
+
+  // producer/consumer bodies get dispatched to the given pool, the pool must outlive go() calls
+  void set_worker_pool(WorkerPool& pool) { worker_pool_ = &pool; }
+
   std::string key() const { return make_hidden_unique_key(); }
   std::string name() const { return name_; }
   std::string vendor() const { return vendor_; }
   size_t ring_buffer_sz() const { return ring_buffer_sz_; }
+
+  // what constructing the vendor contexts of this instance cost
+  const MemoryFootprint& memory_footprint() const { return memory_footprint_; }
+
+  // policy the vendor contexts were allocated with, unsupported:<policy> if the queue ignored it
+  std::string alloc_policy() const { return alloc_policy_; }
+
+  // name of the placement scenario, falls back to custom/unpinned if no scenario was given
+  std::string placement() const
+  {
+    if (!placement_.empty())
+      return placement_;
+    return producer_cores().empty() && consumer_cores().empty() ? "unpinned" : "custom";
+  }
+
+protected:
+  void set_memory_footprint(const MemoryFootprint& footprint) { memory_footprint_ = footprint; }
+
+  // To be called once the contexts got constructed within scope. Placements which bind the ring
+  // buffers to a NUMA node, e.g. numa_p0_c1_mem1, are only what they claim to be if the contexts
+  // honoured the policy, so they fail rather than report numbers for whatever node it landed on.
+  void set_alloc_policy(const BenchmarkParams& params, AllocationPolicyScope& scope)
+  {
+    AllocationPolicy policy = params.context_alloc();
+    bool applied = scope.end();
+    if (params.placement.memory_node >= 0 && !applied)
+    {
+      throw std::runtime_error("placement " + params.placement.name +
+                               " binds the ring buffer to a NUMA node, but " + vendor_ +
+                               " contexts ignore the allocation policy");
+    }
+
+    alloc_policy_ = policy.is_default() || applied ? policy.to_string() : "unsupported:" + policy.to_string();
+  }
+
+  // runs body as the thread_idx-th thread of the benchmark, every body of a run must be launched
+  // before join_all() is called as the bodies wait for each other
+  void launch(size_t thread_idx, std::function<void()> body) { worker_pool().launch(thread_idx, std::move(body)); }
+
+  // set once a body of the current run has thrown, see WorkerPool::run_aborted()
+  const std::atomic_bool& run_aborted() { return worker_pool().run_aborted(); }
+
+  // to be called by bodies spinning until the other bodies are ready
+  void throw_if_run_aborted() { worker_pool().throw_if_aborted(); }
+
+  void join_all()
+  {
+    if (worker_pool_)
+      worker_pool_->join_all();
+  }
 };
@@ -0,0 +1,208 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Compile time Cartesian product of vendors x messages x topologies x tunings, which replaces
+// hand written registration blocks. The building blocks are:
+//  - vendor binding: a struct with
+//      template <class T, size_t P, size_t C, class Tuning> using Context = ...;
+//      template <class ProduceOneMessage, class Ctx, class Tuning> using ProduceAll = ...;
+//      template <class ProcessOneMessage, class Ctx, class Tuning> using ConsumeAll = ...;
+//      template <class T, size_t P, size_t C> static constexpr bool supports = ...;
+//      using tunings = TypeList<...>; // TypeList<DefaultTuning> for queues without knobs
+//  - message binding: a struct with type, creator, processor and NAME
+//  - topology: GridTopology<PRODUCER_N, CONSUMER_N>
+
+template <class... Ts>
+struct TypeList
+{
+};
+
+template <size_t... Vs>
+struct ValueList
+{
+};
+
+template <size_t _PRODUCER_N_, size_t _CONSUMER_N_>
+struct GridTopology
+{
+  static constexpr size_t PRODUCER_N = _PRODUCER_N_;
+  static constexpr size_t CONSUMER_N = _CONSUMER_N_;
+
+  // e.g. spsc, mpsc_2x1, mpmc_4x4
+  static std::string name()
+  {
+    std::string kind = std::string(PRODUCER_N > 1 ? "mp" : "sp") + (CONSUMER_N > 1 ? "mc" : "sc");
+    if (PRODUCER_N == 1 && CONSUMER_N == 1)
+      return kind;
+    return kind + "_" + std::to_string(PRODUCER_N) + "x" + std::to_string(CONSUMER_N);
+  }
+};
+
+struct DefaultTuning
+{
+  static std::string name() { return ""; }
+};
+
+// mgark's _BATCH_NUM_ and _CPU_PAUSE_N_ knobs
+template <size_t _BATCH_NUM_, size_t _CPU_PAUSE_N_>
+struct BatchPauseTuning
+{
+  static constexpr size_t BATCH_NUM = _BATCH_NUM_;
+  static constexpr size_t CPU_PAUSE_N = _CPU_PAUSE_N_;
+
+  static std::string name()
+  {
+    return "batch" + std::to_string(BATCH_NUM) + "_pause" + std::to_string(CPU_PAUSE_N);
+  }
+};
+
+// how many messages the benchmark drivers produce and consume at a time
+template <size_t _BATCH_N_>
+struct DriverBatchTuning
+{
+  static constexpr size_t BATCH_N = _BATCH_N_;
+
+  static std::string name() { return "n" + std::to_string(BATCH_N); }
+};
+
+namespace detail
+{
+template <class... Lists>
+struct Concat;
+
+template <>
+struct Concat<>
+{
+  using type = TypeList<>;
+};
+
+template <class... Ts>
+struct Concat<TypeList<Ts...>>
+{
+  using type = TypeList<Ts...>;
+};
+
+template <class... Ts, class... Us, class... Rest>
+struct Concat<TypeList<Ts...>, TypeList<Us...>, Rest...>
+{
+  using type = typename Concat<TypeList<Ts..., Us...>, Rest...>::type;
+};
+
+template <class BatchNums, class PauseNums>
+struct BatchPauseProduct;
+
+template <size_t... BATCH_NUMS, size_t... PAUSE_NUMS>
+struct BatchPauseProduct<ValueList<BATCH_NUMS...>, ValueList<PAUSE_NUMS...>>
+{
+  template <size_t BATCH_NUM>
+  using Row = TypeList<BatchPauseTuning<BATCH_NUM, PAUSE_NUMS>...>;
+
+  using type = typename Concat<Row<BATCH_NUMS>...>::type;
+};
+
+template <class BatchNums>
+struct DriverBatchList;
+
+template <size_t... BATCH_NS>
+struct DriverBatchList<ValueList<BATCH_NS...>>
+{
+  using type = TypeList<DriverBatchTuning<BATCH_NS>...>;
+};
+} // namespace detail
+
+// every BatchPauseTuning of the two value lists, e.g.
+// BatchPauseGrid<ValueList<4, 32>, ValueList<0, 30>>
+template <class BatchNums, class PauseNums>
+using BatchPauseGrid = typename detail::BatchPauseProduct<BatchNums, PauseNums>::type;
+
+// a DriverBatchTuning for every value, e.g. DriverBatchGrid<ValueList<1, 16, 256>>
+template <class BatchNums>
+using DriverBatchGrid = typename detail::DriverBatchList<BatchNums>::type;
+
+// combinations the vendor cannot run, e.g. an SPSC queue with 2 producers, are not instantiated
+template <class Vendor, class Msg, class Topology, class Tuning>
+concept GridCell =
+  Vendor::template supports<typename Msg::type, Topology::PRODUCER_N, Topology::CONSUMER_N> &&
+  requires {
+    typename Vendor::template Context<typename Msg::type, Topology::PRODUCER_N, Topology::CONSUMER_N,
+                                      Tuning>;
+  };
+
+template <class Vendors, class Msgs, class Topologies>
+struct BenchmarkGrid;
+
+template <class... Vendors, class... Msgs, class... Topologies>
+struct BenchmarkGrid<TypeList<Vendors...>, TypeList<Msgs...>, TypeList<Topologies...>>
+{
+  // Calls f.template operator()<Vendor, Msg, Topology, Tuning>(name) for every valid cell, name is
+  // <prefix>_<topology>_<message>[_<tuning>], e.g. grid_mpsc_2x1_uint32_batch32_pause30.
+  template <class F>
+  static void for_each(const std::string& prefix, F&& f)
+  {
+    (for_each_of_vendor<Vendors>(prefix, f), ...);
+  }
+
+  // number of valid cells, i.e. of for_each() calls
+  static constexpr size_t size() { return (size_of_vendor<Vendors>() + ... + 0); }
+
+private:
+  template <class Vendor, class Msg, class Topology, class Tuning, class F>
+  static void visit(const std::string& prefix, F& f)
+  {
+    if constexpr (GridCell<Vendor, Msg, Topology, Tuning>)
+    {
+      std::string name = prefix + "_" + Topology::name() + "_" + Msg::NAME;
+      if (!Tuning::name().empty())
+        name += "_" + Tuning::name();
+      f.template operator()<Vendor, Msg, Topology, Tuning>(name);
+    }
+  }
+
+  template <class Vendor, class Msg, class Topology, class... Tunings, class F>
+  static void visit_tunings(const std::string& prefix, F& f, TypeList<Tunings...>)
+  {
+    (visit<Vendor, Msg, Topology, Tunings>(prefix, f), ...);
+  }
+
+  template <class Vendor, class F>
+  static void for_each_of_vendor(const std::string& prefix, F& f)
+  {
+    auto for_msg = [&]<class Msg>()
+    { (visit_tunings<Vendor, Msg, Topologies>(prefix, f, typename Vendor::tunings{}), ...); };
+    (for_msg.template operator()<Msgs>(), ...);
+  }
+
+  template <class Vendor, class Msg, class Topology, class... Tunings>
+  static constexpr size_t size_of_tunings(TypeList<Tunings...>)
+  {
+    return ((GridCell<Vendor, Msg, Topology, Tunings> ? 1 : 0) + ... + 0);
+  }
+
+  template <class Vendor>
+  static constexpr size_t size_of_vendor()
+  {
+    size_t n = 0;
+    auto for_msg = [&]<class Msg>()
+    { n += (size_of_tunings<Vendor, Msg, Topologies>(typename Vendor::tunings{}) + ... + 0); };
+    (for_msg.template operator()<Msgs>(), ...);
+    return n;
+  }
+};
@@ -0,0 +1,120 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "benchmark_one_way_latency.h"
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+// a single point of the latency-vs-load curve
+struct LoadSweepStats
+{
+  double load_pct;
+  double max_msg_per_second; // unpaced throughput the load is relative to
+  OneWayLatencyBenchmarkStats point;
+
+  static std::string csv_header()
+  {
+    return std::string("load_pct,max_msg_sec,") + OneWayLatencyBenchmarkStats::csv_header();
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const LoadSweepStats& s)
+  {
+    o << std::fixed << std::setprecision(0) << s.load_pct << "," << s.max_msg_per_second << ","
+      << s.point;
+    return o;
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const std::vector<LoadSweepStats>& ss)
+  {
+    for (const auto& s : ss)
+      o << s;
+    return o;
+  }
+};
+
+// Latency-vs-load curve for open-loop benchmarks: max throughput of every benchmark is measured
+// first by running it unpaced, then it is offered each load as a percentage of its own max.
+class LoadSweep
+{
+public:
+  // creates the benchmark publishing at the given total msg/sec rate, 0 means unpaced
+  using RatedBenchmarkCreator =
+    std::function<std::unique_ptr<BenchmarkBase<OneWayLatencySingleRunResult>>(double msg_per_second)>;
+
+  LoadSweep(size_t iteration_num, std::vector<RatedBenchmarkCreator> creators,
+            std::vector<double> load_pcts = {10, 20, 30, 40, 50, 60, 70, 80, 90, 100})
+    : creators_(std::move(creators)), load_pcts_(std::move(load_pcts)), iteration_num_(iteration_num)
+  {
+    for (double load_pct : load_pcts_)
+    {
+      if (load_pct <= 0)
+        throw std::runtime_error("offered load must be a positive percentage of max throughput");
+    }
+  }
+
+  // applied to every point of the curve, including the unpaced max throughput run
+  void set_adaptive_stopping(const AdaptiveStopping& policy) { stopping_ = policy; }
+
+  // samples of every point of the curve, keys are suffixed with the offered load
+  const std::vector<ResultRecord>& records() const { return records_; }
+
+  std::vector<LoadSweepStats> go(size_t N)
+  {
+    std::vector<LoadSweepStats> result;
+    for (const RatedBenchmarkCreator& creator : creators_)
+    {
+      double max_msg_per_second = run(creator, 0, N, "max").msg_per_second;
+      for (double load_pct : load_pcts_)
+      {
+        std::ostringstream load;
+        load << load_pct << "pct";
+        result.push_back(LoadSweepStats{
+          load_pct, max_msg_per_second,
+          run(creator, max_msg_per_second * load_pct / 100.0, N, load.str())});
+      }
+    }
+
+    return result;
+  }
+
+private:
+  std::vector<RatedBenchmarkCreator> creators_;
+  std::vector<double> load_pcts_;
+  size_t iteration_num_;
+  AdaptiveStopping stopping_;
+  std::vector<ResultRecord> records_;
+
+  OneWayLatencyBenchmarkStats run(const RatedBenchmarkCreator& creator, double msg_per_second,
+                                  size_t N, const std::string& load)
+  {
+    // a suite per rate, as runs at different rates of the same benchmark share the same key
+    OneWayLatencyBenchmarkSuite suite(
+      iteration_num_, {[&creator, msg_per_second]() { return creator(msg_per_second); }});
+    suite.set_adaptive_stopping(stopping_);
+    OneWayLatencyBenchmarkStats stats = suite.go(N).front();
+    for (ResultRecord& r : suite.records())
+    {
+      r.key += "@" + load;
+      records_.push_back(std::move(r));
+    }
+    return stats;
+  }
+};
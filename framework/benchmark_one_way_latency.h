@@ -0,0 +1,505 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "benchmark_base.h"
+#include "benchmark_suite.h"
+#include "cpu_affinity.h"
+#include "factory.h"
+#include "latency_histogram.h"
+#include "statistics.h"
+#include "tsc_clock.h"
+#include "utils.h"
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+// message header carrying the producer's TSC, the consumer takes the delta on receipt
+template <class T>
+struct Timestamped
+{
+  uint64_t tsc;
+  T payload;
+};
+
+// how far behind its schedule a pacer fell, e.g. because the queue was full
+struct PacerStats
+{
+  uint64_t late_num{0}; // publishes which started after their scheduled time
+  uint64_t max_lag_cycles{0};
+
+  void record_lag(uint64_t lag_cycles)
+  {
+    ++late_num;
+    max_lag_cycles = std::max(max_lag_cycles, lag_cycles);
+  }
+
+  void merge(const PacerStats& other)
+  {
+    late_num += other.late_num;
+    max_lag_cycles = std::max(max_lag_cycles, other.max_lag_cycles);
+  }
+};
+
+// spreads publishing evenly, so that the queue is not saturated and the measured latency is not
+// dominated by the time messages spend waiting behind each other. interval of 0 means no pacing.
+struct ConstantRatePacer
+{
+  uint64_t interval_cycles{0};
+  uint64_t next_tsc{0};
+  PacerStats stats;
+
+  ConstantRatePacer() = default;
+  explicit ConstantRatePacer(uint64_t interval) : interval_cycles(interval) {}
+
+  void wait()
+  {
+    if (interval_cycles == 0)
+      return;
+
+    uint64_t now = TscClock::rdtsc();
+    if (next_tsc == 0)
+      next_tsc = now;
+
+    if (now > next_tsc)
+      stats.record_lag(now - next_tsc);
+
+    while (now < next_tsc)
+    {
+      _mm_pause();
+      now = TscClock::rdtsc();
+    }
+
+    // if the producer fell behind (e.g. the queue was full) it does not try to catch up with a
+    // burst, the next message is simply published one interval later
+    next_tsc = std::max(next_tsc, now) + interval_cycles;
+  }
+
+  // the value to be stamped into the message which is about to be published
+  uint64_t stamp(uint64_t now) const { return now; }
+};
+
+// Open-loop load generator: publishes follow a fixed TSC timetable which does not move when the
+// producer falls behind, and messages are stamped with their intended send time rather than the
+// actual one. Time a message spent waiting for the producer to get through the backlog, e.g.
+// while the queue was full, is then part of its latency instead of being silently omitted, which
+// is what a closed-loop producer does (coordinated omission).
+struct OpenLoopPacer
+{
+  uint64_t interval_cycles{0};
+  uint64_t next_tsc{0};
+  uint64_t intended_tsc{0};
+  PacerStats stats;
+
+  OpenLoopPacer() = default;
+  explicit OpenLoopPacer(uint64_t interval) : interval_cycles(interval) {}
+
+  void wait()
+  {
+    if (interval_cycles == 0)
+      return;
+
+    uint64_t now = TscClock::rdtsc();
+    if (next_tsc == 0)
+      next_tsc = now;
+
+    intended_tsc = next_tsc;
+    next_tsc += interval_cycles;
+    if (now > intended_tsc)
+    {
+      stats.record_lag(now - intended_tsc);
+      return;
+    }
+
+    while (now < intended_tsc)
+    {
+      _mm_pause();
+      now = TscClock::rdtsc();
+    }
+  }
+
+  uint64_t stamp(uint64_t now) const { return interval_cycles ? intended_tsc : now; }
+};
+
+template <class T, class ProduceOneMessage, class Pacer = ConstantRatePacer>
+struct ProduceTimestamped
+{
+  using pacer_type = Pacer;
+
+  ProduceOneMessage inner;
+  Pacer pacer;
+
+  Timestamped<T> operator()()
+  {
+    pacer.wait();
+    Timestamped<T> msg{0, inner()};
+    msg.tsc = pacer.stamp(TscClock::rdtsc()); // as close to the actual publish as we can get
+    return msg;
+  }
+};
+
+template <class T, class ProcessOneMessage>
+struct ConsumeTimestamped
+{
+  ProcessOneMessage inner;
+  LatencyHistogram* histogram{nullptr}; // set by the benchmark, one per consumer thread
+
+  void operator()(const Timestamped<T>& msg)
+  {
+    uint64_t published_tsc = msg.tsc;
+    uint64_t received_tsc = TscClock::rdtscp();
+    inner(msg.payload);
+
+    // TSCs are synchronized across cores on invariant TSC machines, but a tiny negative skew is
+    // still possible for cores on different sockets
+    histogram->record(received_tsc > published_tsc ? received_tsc - published_tsc : 0);
+  }
+};
+
+struct OneWayLatencySingleRunResult
+{
+  size_t total_msg_num;
+  double target_msg_per_second;
+  double msg_per_second;
+  uint64_t late_msg_num;       // publishes which missed their schedule, across all producers
+  double max_backlog_msg_num;  // the furthest any producer fell behind, in messages
+  double median_latency_ns;    // of this run alone, the histogram is only kept until the suite merges it
+  std::unique_ptr<LatencyHistogram> histogram; // producer to consumer latency in TSC cycles
+
+  friend std::ostream& operator<<(std::ostream& o, const OneWayLatencySingleRunResult& s)
+  {
+    o << std::fixed << std::setprecision(5) << s.total_msg_num << "," << s.target_msg_per_second
+      << "," << s.msg_per_second << "," << s.late_msg_num << "," << s.max_backlog_msg_num << "\n";
+    return o;
+  }
+};
+
+struct OneWayLatencyBenchmarkStats
+{
+  std::string benchmark_name;
+  std::string vendor;
+  size_t ring_buffer_sz;
+  size_t iteration_num;
+  size_t N;
+  std::string msg_type_name;
+  size_t producer_num;
+  size_t consumer_num;
+  std::string placement;
+  std::string alloc_policy;
+  std::string producer_cores;
+  std::string consumer_cores;
+  double target_msg_per_second;
+  double msg_per_second;
+  double late_msg_pct;
+  double max_backlog_msg_num;
+  LatencyPercentiles latency;
+  RunDistribution runs; // of per-run median latency ns
+  MemoryFootprint memory;
+
+  static std::string csv_header()
+  {
+    return std::string("name,vendor,ring_buffer_sz,iteration_n,msg_n,msg_type,producer_n,consumer_n,"
+                       "placement,alloc_policy,producer_cores,consumer_cores,target_msg_sec,msg_sec,"
+                       "late_msg_pct,max_backlog_msg,") +
+      LatencyPercentiles::csv_header() + "," + RunDistribution::csv_header("run_50_ns") + "," +
+      MemoryFootprint::csv_header() + "\n";
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const OneWayLatencyBenchmarkStats& s)
+  {
+    o << s.benchmark_name << "," << s.vendor << "," << s.ring_buffer_sz << "," << s.iteration_num
+      << "," << s.N << "," << s.msg_type_name << "," << s.producer_num << "," << s.consumer_num
+      << "," << s.placement << "," << s.alloc_policy << "," << s.producer_cores << ","
+      << s.consumer_cores << ","
+      << std::fixed << std::setprecision(0) << s.target_msg_per_second << "," << s.msg_per_second
+      << "," << std::setprecision(3) << s.late_msg_pct << "," << s.max_backlog_msg_num << ","
+      << s.latency << "," << s.runs << "," << s.memory << "\n";
+    return o;
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const std::vector<OneWayLatencyBenchmarkStats>& ss)
+  {
+    for (const auto& s : ss)
+      o << s;
+    return o;
+  }
+};
+
+class OneWayLatencyBenchmarkSuite
+  : public BenchmarkSuiteBase<OneWayLatencySingleRunResult, OneWayLatencyBenchmarkStats>
+{
+public:
+  using Base = BenchmarkSuiteBase<OneWayLatencySingleRunResult, OneWayLatencyBenchmarkStats>;
+  using Base::BenchmarkSuiteBase;
+  using Base::go;
+  using BenchmarkRunResult = OneWayLatencySingleRunResult;
+
+protected:
+  std::vector<OneWayLatencyBenchmarkStats> calc_summary(typename Base::BenchmarkResultsMap& benchmark_results) override
+  {
+    std::vector<OneWayLatencyBenchmarkStats> result;
+    for (auto& per_benchmark : benchmark_results)
+    {
+      double msg_per_second_sum = 0;
+      uint64_t late_msg_num = 0;
+      double max_backlog_msg_num = 0;
+      const std::vector<OneWayLatencySingleRunResult>& run_stats = per_benchmark.second.runs;
+      for (const OneWayLatencySingleRunResult& run : run_stats)
+      {
+        if (run.total_msg_num != run_stats.front().total_msg_num)
+        {
+          throw std::runtime_error(
+            std::string("benchmark [").append(per_benchmark.first).append("] had CRITICAL failures as not all messages were published/consumed - queue appear to have bugs..."));
+        }
+
+        msg_per_second_sum += run.msg_per_second;
+        late_msg_num += run.late_msg_num;
+        max_backlog_msg_num = std::max(max_backlog_msg_num, run.max_backlog_msg_num);
+      }
+
+      OneWayLatencyBenchmarkStats s;
+      {
+        s.benchmark_name = per_benchmark.second.name;
+        s.N = run_stats.front().total_msg_num;
+        s.iteration_num = run_stats.size();
+
+        s.vendor = per_benchmark.second.vendor;
+        s.ring_buffer_sz = per_benchmark.second.ring_buffer_sz;
+
+        s.msg_type_name = per_benchmark.second.msg_type_name;
+        s.producer_num = per_benchmark.second.producer_num;
+        s.consumer_num = per_benchmark.second.consumer_num;
+        s.placement = per_benchmark.second.placement;
+        s.alloc_policy = per_benchmark.second.alloc_policy;
+        s.producer_cores = format_core_list(per_benchmark.second.producer_cores);
+        s.consumer_cores = format_core_list(per_benchmark.second.consumer_cores);
+
+        s.target_msg_per_second = run_stats.front().target_msg_per_second;
+        s.msg_per_second = msg_per_second_sum / run_stats.size();
+        s.late_msg_pct = 100.0 * late_msg_num / (s.N * run_stats.size());
+        s.max_backlog_msg_num = max_backlog_msg_num;
+        s.latency = LatencyPercentiles::from_cycles(histograms_[per_benchmark.first]);
+        s.runs = RunDistribution::of(run_metrics(run_stats));
+        s.memory = per_benchmark.second.memory;
+
+        result.push_back(s);
+      }
+    }
+
+    return result;
+  }
+
+  void absorb_run(const std::string& key, OneWayLatencySingleRunResult& run) override
+  {
+    histograms_[key].merge(*run.histogram);
+    run.histogram.reset();
+  }
+
+  double run_metric(const OneWayLatencySingleRunResult& run) const override
+  {
+    return run.median_latency_ns;
+  }
+
+  std::string run_metric_name() const override { return "median_one_way_ns"; }
+
+private:
+  std::unordered_map<std::string /*benchmark key*/, LatencyHistogram> histograms_; // of every run
+};
+
+// Producers stamp every message with the TSC right before publishing it and consumers record
+// the delta on receipt, so unlike LatencyBenchmark it measures a single hop. T is the queue's
+// message type, i.e. Timestamped<Payload>, ProduceAllMessage and ConsumeAllMessage are the
+// regular vendor adapters instantiated with ProduceTimestamped and ConsumeTimestamped.
+template <class T, class BenchmarkContext, std::size_t _PRODUCER_N_, std::size_t _CONSUMER_N_,
+          class ProduceAllMessage, class ConsumeAllMessage, bool multicast_consumers = false>
+class OneWayLatencyBenchmark : public BenchmarkBase<OneWayLatencySingleRunResult>
+{
+  using Base = BenchmarkBase<OneWayLatencySingleRunResult>;
+
+  std::vector<std::size_t> producer_cores_;
+  std::vector<std::size_t> consumer_cores_;
+  double msg_per_second_;
+
+  AllocationPolicyScope context_alloc_scope_; // must stay before the contexts
+  MemoryProbe context_probe_;                 // must stay right before the contexts
+  BenchmarkContext ctx_;
+
+public:
+  using context_type = BenchmarkContext;
+  static constexpr size_t PRODUCER_THREAD_N = _PRODUCER_N_;
+  static constexpr size_t CONSUMER_THREAD_N = _CONSUMER_N_;
+
+  OneWayLatencyBenchmark(const std::string& name, const BenchmarkParams& params)
+    : Base(name, BenchmarkContext::VENDOR, params.ring_buffer_sz, params.placement.name),
+      producer_cores_(params.placement.producer_cores),
+      consumer_cores_(params.placement.consumer_cores),
+      msg_per_second_(params.msg_per_second),
+      context_alloc_scope_(params.context_alloc()),
+      ctx_(params.ring_buffer_sz)
+  {
+    check_core_list(producer_cores_, _PRODUCER_N_, "producer");
+    check_core_list(consumer_cores_, _CONSUMER_N_, "consumer");
+    set_memory_footprint(context_probe_.finish(params.ring_buffer_sz));
+    set_alloc_policy(params, context_alloc_scope_);
+
+    if constexpr (requires { ProduceAllMessage::validate(ctx_); })
+      ProduceAllMessage::validate(ctx_);
+
+    if (msg_per_second_ < 0)
+      throw std::runtime_error("msg_per_second must not be negative");
+
+    TscClock::instance(); // calibrate outside of the measured window
+  }
+
+  std::string msg_type_name() const override { return typeid(T).name(); }
+  size_t msg_size() const override { return sizeof(T); }
+  size_t producer_num() const override { return _PRODUCER_N_; }
+  size_t consumer_num() const override { return _CONSUMER_N_; }
+  std::vector<size_t> producer_cores() const override { return producer_cores_; }
+  std::vector<size_t> consumer_cores() const override { return consumer_cores_; }
+
+  OneWayLatencySingleRunResult go(size_t N) override
+  {
+    using ProducerMsgCreator = typename ProduceAllMessage::message_creator;
+    using ConsumerMsgProcessor = typename ConsumeAllMessage::message_processor;
+    using Pacer = typename ProducerMsgCreator::pacer_type;
+
+    std::atomic_uint64_t start_tsc{0};
+    uint64_t end_tsc;
+
+    std::atomic_uint64_t producers_ready_num{0};
+    std::atomic_uint64_t consumers_ready_num{0};
+    std::atomic_uint64_t total_msg_published{0};
+    std::atomic_uint64_t total_msg_consumed{0};
+
+    size_t per_consumer_num;
+    size_t total_consume_num;
+    size_t per_producer_num{N / _PRODUCER_N_};
+    if constexpr (multicast_consumers)
+      per_consumer_num = per_producer_num * _PRODUCER_N_;
+    else
+      per_consumer_num = (per_producer_num * _PRODUCER_N_) / _CONSUMER_N_;
+
+    total_consume_num = per_consumer_num * _CONSUMER_N_;
+
+    // the rate is for all producers together
+    uint64_t interval_cycles = msg_per_second_ > 0
+      ? TscClock::instance().ns_to_cycles(NANO_PER_SEC * _PRODUCER_N_ / msg_per_second_)
+      : 0;
+
+    // one histogram per consumer, allocated upfront so that nothing is allocated while measuring
+    std::vector<LatencyHistogram> histograms(_CONSUMER_N_);
+    std::vector<PacerStats> pacer_stats(_PRODUCER_N_);
+
+    for (size_t producer_id = 0; producer_id < _PRODUCER_N_; ++producer_id)
+    {
+      launch(producer_id,
+        [&, producer_id]()
+        {
+          place_current_thread(producer_cores_, producer_id);
+
+          while (consumers_ready_num.load() < _CONSUMER_N_)
+          {
+            // all producers and consumers must indicate that they are ready!
+            throw_if_run_aborted();
+          }
+
+          ProducerMsgCreator mc{{}, Pacer(interval_cycles)};
+          ProduceAllMessage msg_producer(per_producer_num, ctx_, mc);
+          ++producers_ready_num;
+
+          while (producers_ready_num.load() < _PRODUCER_N_)
+          {
+            // all producers and consumers must indicate that they are ready!
+            throw_if_run_aborted();
+          }
+
+          uint64_t expected_tsc{0};
+          start_tsc.compare_exchange_strong(expected_tsc, TscClock::rdtsc(), std::memory_order_release);
+
+          total_msg_published.fetch_add(msg_producer());
+          pacer_stats[producer_id] = mc.pacer.stats;
+        });
+    }
+
+    for (size_t consumer_id = 0; consumer_id < _CONSUMER_N_; ++consumer_id)
+    {
+      launch(_PRODUCER_N_ + consumer_id,
+        [&, consumer_id]()
+        {
+          place_current_thread(consumer_cores_, consumer_id);
+
+          ConsumerMsgProcessor mp;
+          mp.histogram = &histograms[consumer_id];
+          ConsumeAllMessage msg_consumer(per_consumer_num, ctx_, mp);
+          ++consumers_ready_num;
+
+          while (producers_ready_num.load() < _PRODUCER_N_ || consumers_ready_num.load() < _CONSUMER_N_)
+          {
+            // all producers and consumers must indicate that they are ready!
+            throw_if_run_aborted();
+          }
+
+          auto actual_consumed_num = msg_consumer();
+          total_msg_consumed.fetch_add(actual_consumed_num);
+          if (actual_consumed_num != per_consumer_num)
+          {
+            std::stringstream ss;
+            ss << "Consumer [" << consumer_id << "] should have consumed [" << per_consumer_num
+               << "], but instead consumed [" << actual_consumed_num
+               << "] which suggest a serious issue with queue's implementation";
+            throw std::runtime_error(ss.str());
+          }
+        });
+    }
+
+    join_all();
+
+    end_tsc = TscClock::rdtscp();
+
+    if (total_consume_num != total_msg_consumed)
+    {
+      std::stringstream ss;
+      ss << "total_msg_consumed[" << total_msg_consumed << "] not equal target number ["
+         << total_consume_num << "]";
+      throw std::runtime_error(ss.str());
+    }
+
+    OneWayLatencySingleRunResult summary;
+    {
+      summary.total_msg_num = total_msg_published;
+      summary.target_msg_per_second = msg_per_second_;
+      summary.msg_per_second = static_cast<double>(total_msg_published) /
+        (TscClock::instance().cycles_to_ns(end_tsc - start_tsc.load()) / static_cast<double>(NANO_PER_SEC));
+      summary.histogram = std::make_unique<LatencyHistogram>();
+      for (const LatencyHistogram& h : histograms)
+        summary.histogram->merge(h);
+      summary.median_latency_ns =
+        TscClock::instance().cycles_to_ns(summary.histogram->value_at_percentile(50));
+
+      PacerStats merged_pacer_stats;
+      for (const PacerStats& p : pacer_stats)
+        merged_pacer_stats.merge(p);
+      summary.late_msg_num = merged_pacer_stats.late_num;
+      summary.max_backlog_msg_num =
+        interval_cycles ? merged_pacer_stats.max_lag_cycles / static_cast<double>(interval_cycles) : 0;
+    }
+
+    return summary;
+  }
+};
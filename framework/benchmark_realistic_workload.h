@@ -0,0 +1,229 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "benchmark_one_way_latency.h"
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// Inter-arrival distributions, all of them are parametrized by the mean interval in TSC cycles
+// which is derived from the requested msg/sec rate. Mean of 0 means publishing back to back.
+struct FixedArrivals
+{
+  uint64_t mean_interval_cycles{0};
+
+  FixedArrivals() = default;
+  explicit FixedArrivals(uint64_t mean) : mean_interval_cycles(mean) {}
+
+  uint64_t next_interval() { return mean_interval_cycles; }
+};
+
+struct UniformArrivals
+{
+  std::mt19937_64 rng{std::random_device{}()};
+  std::uniform_int_distribution<uint64_t> dist;
+
+  UniformArrivals() : UniformArrivals(0) {}
+  explicit UniformArrivals(uint64_t mean) : dist(0, 2 * mean) {}
+
+  uint64_t next_interval() { return dist(rng); }
+};
+
+// Poisson arrivals, i.e. the random bursts with quiet gaps in between we see in market data
+struct ExponentialArrivals
+{
+  std::mt19937_64 rng{std::random_device{}()};
+  std::exponential_distribution<double> dist;
+  bool paced{false};
+
+  ExponentialArrivals() = default;
+  explicit ExponentialArrivals(uint64_t mean)
+    : dist(mean > 0 ? 1.0 / mean : 1.0), paced(mean > 0)
+  {
+  }
+
+  uint64_t next_interval() { return paced ? static_cast<uint64_t>(dist(rng)) : 0; }
+};
+
+// "Other work" kernels which run in between messages to make caches and predictors dirty
+
+struct NoWork
+{
+  void operator()() {}
+};
+
+// Walks a random cyclic permutation of cache lines over a BUFFER_MB sized buffer, touching
+// STEPS_NUM lines per call. Lines get written to, so that they are evicted dirty from L1/L2 and
+// the queue's own lines have to be brought back from the further levels.
+template <size_t BUFFER_MB, size_t STEPS_NUM = 64>
+class MemoryWalkWork
+{
+  struct alignas(64) Line
+  {
+    uint32_t next;
+    uint32_t touched;
+  };
+
+  std::vector<Line> lines_;
+  uint32_t cursor_{0};
+
+public:
+  MemoryWalkWork() : lines_(BUFFER_MB * 1024 * 1024 / sizeof(Line))
+  {
+    // Sattolo's algorithm, produces a single cycle visiting every line
+    std::vector<uint32_t> order(lines_.size());
+    std::iota(begin(order), end(order), 0);
+    std::mt19937 rng{std::random_device{}()};
+    for (size_t i = order.size() - 1; i > 0; --i)
+      std::swap(order[i], order[std::uniform_int_distribution<size_t>(0, i - 1)(rng)]);
+
+    for (size_t i = 0; i < order.size(); ++i)
+      lines_[order[i]].next = order[(i + 1) % order.size()];
+  }
+
+  void operator()()
+  {
+    uint32_t cursor = cursor_;
+    for (size_t i = 0; i < STEPS_NUM; ++i)
+    {
+      Line& line = lines_[cursor];
+      ++line.touched;
+      cursor = line.next;
+    }
+
+    cursor_ = cursor;
+  }
+};
+
+// Data dependent branches over random bytes, the predictor cannot learn them so it is left
+// trained on garbage by the time the next message arrives
+template <size_t ITERATION_NUM = 256>
+class BranchyWork
+{
+  std::vector<uint8_t> data_;
+  size_t idx_{0};
+  volatile uint64_t sink_{0};
+
+public:
+  BranchyWork() : data_(4096)
+  {
+    std::mt19937 rng{std::random_device{}()};
+    for (uint8_t& v : data_)
+      v = rng();
+  }
+
+  void operator()()
+  {
+    uint64_t acc = sink_;
+    for (size_t i = 0; i < ITERATION_NUM; ++i)
+    {
+      uint8_t v = data_[idx_++ & (data_.size() - 1)];
+      switch (v & 7)
+      {
+      case 0: acc += v; break;
+      case 1: acc ^= acc << 13; break;
+      case 2: acc *= 0x9E3779B97F4A7C15ull; break;
+      case 3: acc -= v * 3; break;
+      case 4: acc ^= acc >> 7; break;
+      case 5: acc = (acc << 5) | (acc >> 59); break;
+      case 6:
+        if (v & 0x80)
+          acc += 17;
+        break;
+      default: acc ^= v; break;
+      }
+    }
+
+    sink_ = acc;
+  }
+};
+
+// Pacer which draws the gap to the next publish from Arrivals and runs Work before waiting for
+// it, the way a real producer would be busy with something else between two ticks
+template <class Arrivals, class Work = NoWork>
+struct WorkloadPacer
+{
+  Arrivals arrivals;
+  Work work;
+  uint64_t next_tsc{0};
+  bool paced{false};
+  PacerStats stats;
+
+  WorkloadPacer() = default;
+  explicit WorkloadPacer(uint64_t mean_interval_cycles)
+    : arrivals(mean_interval_cycles), paced(mean_interval_cycles > 0)
+  {
+  }
+
+  void wait()
+  {
+    work();
+
+    uint64_t now = TscClock::rdtsc();
+    if (next_tsc == 0)
+      next_tsc = now;
+
+    if (paced && now > next_tsc)
+      stats.record_lag(now - next_tsc);
+
+    while (now < next_tsc)
+    {
+      _mm_pause();
+      now = TscClock::rdtsc();
+    }
+
+    next_tsc = std::max(next_tsc, now) + arrivals.next_interval();
+  }
+
+  uint64_t stamp(uint64_t now) const { return now; }
+};
+
+// runs Work after every message, so that the consumer's cache is cold when the next one arrives
+template <class T, class ProcessOneMessage, class Work = NoWork>
+struct ConsumeTimestampedThenWork : ConsumeTimestamped<T, ProcessOneMessage>
+{
+  Work work;
+
+  void operator()(const Timestamped<T>& msg)
+  {
+    ConsumeTimestamped<T, ProcessOneMessage>::operator()(msg);
+    work();
+  }
+};
+
+// One-way latency under a production-like load: messages are published at random intervals
+// drawn from Arrivals with the mean given by BenchmarkParams::msg_per_second, and both sides do
+// unrelated work in between. ProduceAll/ConsumeAll are the vendor adapter templates, e.g.
+// MgarkSingleQueueProduceAll, and BenchmarkContext must be instantiated with Timestamped<T>.
+template <class T, class BenchmarkContext, std::size_t _PRODUCER_N_, std::size_t _CONSUMER_N_,
+          template <class, class> class ProduceAll, template <class, class> class ConsumeAll,
+          class ProduceOneMessage, class ProcessOneMessage, class Arrivals,
+          class ProducerWork = NoWork, class ConsumerWork = NoWork>
+class RealisticWorkloadBenchmark
+  : public OneWayLatencyBenchmark<
+      Timestamped<T>, BenchmarkContext, _PRODUCER_N_, _CONSUMER_N_,
+      ProduceAll<ProduceTimestamped<T, ProduceOneMessage, WorkloadPacer<Arrivals, ProducerWork>>, BenchmarkContext>,
+      ConsumeAll<ConsumeTimestampedThenWork<T, ProcessOneMessage, ConsumerWork>, BenchmarkContext>>
+{
+public:
+  using OneWayLatencyBenchmark<
+    Timestamped<T>, BenchmarkContext, _PRODUCER_N_, _CONSUMER_N_,
+    ProduceAll<ProduceTimestamped<T, ProduceOneMessage, WorkloadPacer<Arrivals, ProducerWork>>, BenchmarkContext>,
+    ConsumeAll<ConsumeTimestampedThenWork<T, ProcessOneMessage, ConsumerWork>, BenchmarkContext>>::OneWayLatencyBenchmark;
+};
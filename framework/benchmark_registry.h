@@ -0,0 +1,91 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "benchmark_base.h"
+#include "cpu_topology.h"
+#include <functional>
+#include <memory>
+#include <regex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Type-erased factories of every compiled vendor/message/topology combination, so that
+// executables can pick and parametrize benchmarks at runtime instead of recompiling mains.
+template <class SingleRunResult>
+class BenchmarkRegistry
+{
+public:
+  using Factory = std::function<std::unique_ptr<BenchmarkBase<SingleRunResult>>(const BenchmarkParams&)>;
+
+  struct Entry
+  {
+    std::string name;
+    std::string vendor;
+    size_t producer_thread_num; // number of cores a placement must provide for each side
+    size_t consumer_thread_num;
+    Factory factory;
+
+    std::string id() const { return name + "/" + vendor; }
+  };
+
+  static BenchmarkRegistry& instance()
+  {
+    static BenchmarkRegistry registry;
+    return registry;
+  }
+
+  template <class ConcreteBenchmark>
+  void add(const std::string& name) requires(
+    std::is_same_v<SingleRunResult, typename ConcreteBenchmark::single_run_result>)
+  {
+    entries_.push_back(Entry{name, ConcreteBenchmark::context_type::VENDOR,
+                             ConcreteBenchmark::PRODUCER_THREAD_N, ConcreteBenchmark::CONSUMER_THREAD_N,
+                             [name](const BenchmarkParams& p)
+                             {
+                               // benchmarks which need more than ring size and placement take
+                               // the params as a whole
+                               if constexpr (std::is_constructible_v<ConcreteBenchmark, const std::string&,
+                                                                     const BenchmarkParams&>)
+                                 return std::make_unique<ConcreteBenchmark>(name, p);
+                               else
+                                 return std::make_unique<ConcreteBenchmark>(
+                                   name, p.ring_buffer_sz, p.placement.producer_cores,
+                                   p.placement.consumer_cores, p.placement.name);
+                             }});
+  }
+
+  const std::vector<Entry>& entries() const { return entries_; }
+
+  // filter is a regex matched against "name/vendor", e.g. "spsc_.*/mgark"
+  std::vector<const Entry*> match(const std::string& filter) const
+  {
+    std::regex re(filter.empty() ? ".*" : filter);
+    std::vector<const Entry*> result;
+    for (const Entry& e : entries_)
+    {
+      if (std::regex_search(e.id(), re))
+        result.push_back(&e);
+    }
+
+    return result;
+  }
+
+private:
+  std::vector<Entry> entries_;
+};
@@ -18,13 +18,19 @@
 
 #include "benchmark_base.h"
 #include "benchmark_suite.h"
+#include "cpu_affinity.h"
 #include "factory.h"
+#include "latency_histogram.h"
+#include "perf_counters.h"
+#include "statistics.h"
+#include "tsc_clock.h"
 #include "utils.h"
 #include <atomic>
 #include <cassert>
 #include <chrono>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <type_traits>
@@ -34,8 +40,12 @@ struct LatencySingleRunResult
   double round_trip_latency_ns_AVG;
   size_t total_msg_num;
   size_t thread_num;
+  size_t warmup_msg_num{0};   // round trips left out of the histogram and the average
+  // per round trip, in TSC cycles, the suite merges it per benchmark and drops it from the stored run
+  std::unique_ptr<LatencyHistogram> histogram;
+  PerfCounterValues perf; // summed over all A and B threads
 
-  friend std::ostream& operator<<(std::ostream& o, LatencySingleRunResult s)
+  friend std::ostream& operator<<(std::ostream& o, const LatencySingleRunResult& s)
   {
     o << std::fixed << std::setprecision(5) << s.total_msg_num << "," << s.round_trip_latency_ns_AVG
       << "," << s.thread_num << "\n";
@@ -54,29 +64,33 @@ struct LatencyBenchmarkStats
   size_t thread_num;
   size_t producer_num;
   size_t consumer_num;
-  size_t min;
-  size_t max;
-  size_t d50;
-  size_t d75;
-  size_t d90;
-  size_t d99;
-
-  static const char* csv_header()
+  std::string placement;
+  std::string alloc_policy;
+  std::string a_cores;
+  std::string b_cores;
+  LatencyPercentiles latency;
+  RunDistribution runs; // of per-run average round trip ns
+  double warmup_discarded_msg; // average over runs
+  MemoryFootprint memory;
+  PerfCountersPerMessage perf; // per round trip
+
+  static std::string csv_header()
   {
-    return "name,vendor,ring_buffer_sz,iteration_n,msg_n,msg_type,thread_num,producer_n,consumer_n,"
-           "min_msg_"
-           "ns,max_msg_ns,50_msg_"
-           "ns,75_"
-           "msg_ns"
-           ",90_msg_ns,99_msg_ns\n";
+    return std::string("name,vendor,ring_buffer_sz,iteration_n,msg_n,msg_type,thread_num,producer_n,"
+                       "consumer_n,placement,alloc_policy,a_cores,b_cores,") +
+      LatencyPercentiles::csv_header() + "," + RunDistribution::csv_header("run_avg_ns") +
+      ",warmup_discarded_msg," + MemoryFootprint::csv_header() + "," +
+      PerfCountersPerMessage::csv_header() + "\n";
   }
 
-  friend std::ostream& operator<<(std::ostream& o, LatencyBenchmarkStats s)
+  friend std::ostream& operator<<(std::ostream& o, const LatencyBenchmarkStats& s)
   {
     o << s.benchmark_name << "," << s.vendor << "," << s.ring_buffer_sz << "," << s.iteration_num
       << "," << s.N << "," << s.msg_type_name << "," << s.thread_num << "," << s.producer_num << ","
-      << s.consumer_num << "," << std::fixed << std::setprecision(5) << s.min << "," << s.max << ","
-      << s.d50 << "," << s.d75 << "," << s.d90 << "," << s.d99 << "\n";
+      << s.consumer_num << "," << s.placement << "," << s.alloc_policy << "," << s.a_cores << ","
+      << s.b_cores << ","
+      << s.latency << "," << s.runs << "," << s.warmup_discarded_msg << "," << s.memory << ","
+      << s.perf << "\n";
     return o;
   }
 
@@ -99,30 +113,28 @@ public:
 protected:
   std::vector<LatencyBenchmarkStats> calc_summary(typename Base::BenchmarkResultsMap& benchmark_results) override
   {
-    if (this->iteration_num_ < 100)
-    {
-      throw std::runtime_error(
-        "please configure iteration_num >= 100, otherwise percentile stats would be highly "
-        "inaccurate");
-    }
-
     std::vector<LatencyBenchmarkStats> result;
     for (auto& per_benchmark : benchmark_results)
     {
-      std::sort(begin(per_benchmark.second.runs), end(per_benchmark.second.runs),
-                [&](const LatencySingleRunResult& left, const LatencySingleRunResult& right)
-                {
-                  if (left.total_msg_num != right.total_msg_num)
-                  {
-                    throw std::runtime_error(
-                      std::string("benchmark [").append(per_benchmark.first).append("] had CRITICAL failures as not all messages were published/consumed - queue appear to have bugs..."));
-                  }
-
-                  return left.round_trip_latency_ns_AVG < right.round_trip_latency_ns_AVG;
-                });
+      // percentiles are taken over every single round trip of every iteration, so unlike
+      // per-run averages they do not need many iterations to be meaningful
+      PerfCountersPerMessage perf{PerfCounterValues::all_available()};
+      double warmup_msg_num_sum{0};
+      const std::vector<LatencySingleRunResult>& run_stats = per_benchmark.second.runs;
+      for (const LatencySingleRunResult& run : run_stats)
+      {
+        if (run.total_msg_num != run_stats.front().total_msg_num)
+        {
+          throw std::runtime_error(
+            std::string("benchmark [").append(per_benchmark.first).append("] had CRITICAL failures as not all messages were published/consumed - queue appear to have bugs..."));
+        }
+
+        perf.totals.merge(run.perf);
+        perf.msg_num += run.total_msg_num;
+        warmup_msg_num_sum += run.warmup_msg_num;
+      }
 
       LatencyBenchmarkStats s;
-      const std::vector<LatencySingleRunResult>& run_stats = per_benchmark.second.runs;
       {
         s.benchmark_name = per_benchmark.second.name;
         s.N = run_stats.front().total_msg_num;
@@ -134,16 +146,17 @@ protected:
         s.msg_type_name = per_benchmark.second.msg_type_name;
         s.producer_num = per_benchmark.second.producer_num;
         s.consumer_num = per_benchmark.second.consumer_num;
+        s.placement = per_benchmark.second.placement;
+        s.alloc_policy = per_benchmark.second.alloc_policy;
+        s.a_cores = format_core_list(per_benchmark.second.producer_cores);
+        s.b_cores = format_core_list(per_benchmark.second.consumer_cores);
         s.thread_num = per_benchmark.second.runs.front().thread_num;
 
-        s.min = run_stats.front().round_trip_latency_ns_AVG;
-        s.max = run_stats.back().round_trip_latency_ns_AVG;
-
-        // a bit crude percentile count, but it would work if iteration num is high enough >= 100
-        s.d50 = run_stats[run_stats.size() * 0.5].round_trip_latency_ns_AVG;
-        s.d75 = run_stats[run_stats.size() * 0.75].round_trip_latency_ns_AVG;
-        s.d90 = run_stats[run_stats.size() * 0.9].round_trip_latency_ns_AVG;
-        s.d99 = run_stats[run_stats.size() * 0.99].round_trip_latency_ns_AVG;
+        s.latency = LatencyPercentiles::from_cycles(histograms_[per_benchmark.first]);
+        s.runs = RunDistribution::of(run_metrics(run_stats));
+        s.warmup_discarded_msg = warmup_msg_num_sum / run_stats.size();
+        s.memory = per_benchmark.second.memory;
+        s.perf = perf;
 
         result.push_back(s);
       }
@@ -151,6 +164,22 @@ protected:
 
     return result;
   }
+
+  void absorb_run(const std::string& key, LatencySingleRunResult& run) override
+  {
+    histograms_[key].merge(*run.histogram);
+    run.histogram.reset();
+  }
+
+  double run_metric(const LatencySingleRunResult& run) const override
+  {
+    return run.round_trip_latency_ns_AVG;
+  }
+
+  std::string run_metric_name() const override { return "avg_round_trip_ns"; }
+
+private:
+  std::unordered_map<std::string /*benchmark key*/, LatencyHistogram> histograms_; // of every run
 };
 
 template <class T, class BenchmarkContext, std::size_t _PRODUCER_N_, std::size_t _CONSUMER_N_,
@@ -162,42 +191,63 @@ class LatencyBenchmark : public BenchmarkBase<LatencySingleRunResult>
 
   using Base = BenchmarkBase<LatencySingleRunResult>;
 
-  std::deque<std::jthread> a_threads_;
-  std::deque<std::jthread> b_threads_;
-
   std::vector<std::size_t> a_cores_;
   std::vector<std::size_t> b_cores_;
+  WarmupPolicy warmup_;
 
+  AllocationPolicyScope context_alloc_scope_; // must stay before the contexts
+  MemoryProbe context_probe_;                 // must stay right before the contexts
   BenchmarkContext a_ctx_;
   BenchmarkContext b_ctx_;
 
-  static_assert(std::atomic<std::chrono::system_clock::time_point>::is_always_lock_free);
-
 public:
+  using context_type = BenchmarkContext;
+  static constexpr size_t PRODUCER_THREAD_N = _THREAD_N_;
+  static constexpr size_t CONSUMER_THREAD_N = _THREAD_N_;
+
   LatencyBenchmark(const std::string& name, size_t ring_buffer_sz,
-                   const std::vector<std::size_t>& a_cores = {}, const std::vector<std::size_t>& b_cores = {})
-    : Base(name, BenchmarkContext::VENDOR, ring_buffer_sz),
-      a_cores_(a_cores),
-      b_cores_(b_cores),
-      a_ctx_(ring_buffer_sz),
-      b_ctx_(ring_buffer_sz)
+                   const std::vector<std::size_t>& a_cores = {}, const std::vector<std::size_t>& b_cores = {},
+                   const std::string& placement = "")
+    : LatencyBenchmark(name,
+                       BenchmarkParams{ring_buffer_sz, PlacementScenario{placement, a_cores, b_cores}})
   {
-    assert(a_cores_.size() == b_cores_.size());
+  }
+
+  LatencyBenchmark(const std::string& name, const BenchmarkParams& params)
+    : Base(name, BenchmarkContext::VENDOR, params.ring_buffer_sz, params.placement.name),
+      a_cores_(params.placement.producer_cores),
+      b_cores_(params.placement.consumer_cores),
+      warmup_(params.warmup),
+      context_alloc_scope_(params.context_alloc()),
+      a_ctx_(params.ring_buffer_sz),
+      b_ctx_(params.ring_buffer_sz)
+  {
+    check_core_list(a_cores_, _THREAD_N_, "A");
+    check_core_list(b_cores_, _THREAD_N_, "B");
+    set_memory_footprint(context_probe_.finish(2 * params.ring_buffer_sz));
+    set_alloc_policy(params, context_alloc_scope_);
+
+    TscClock::instance(); // calibrate outside of the measured window
   }
 
   std::string msg_type_name() const override { return typeid(T).name(); }
+  size_t msg_size() const override { return sizeof(T); }
 
   size_t producer_num() const override { return _PRODUCER_N_; }
   size_t consumer_num() const override { return _CONSUMER_N_; }
 
+  // A threads are reported as producers and B threads as consumers
+  std::vector<size_t> producer_cores() const override { return a_cores_; }
+  std::vector<size_t> consumer_cores() const override { return b_cores_; }
+
   LatencySingleRunResult go(size_t N) override
   {
     using ProducerMsgCreator = typename LatencyA::message_creator;
     using ConsumerMsgProcessor = typename LatencyA::message_processor;
 
     std::mutex guard;
-    std::atomic<std::chrono::system_clock::time_point> start_time_ns{};
-    std::atomic<std::chrono::system_clock::time_point> end_time_ns;
+    std::atomic_uint64_t start_tsc{0};
+    uint64_t end_tsc;
 
     std::atomic_uint64_t a_ready_num{0};
     std::atomic_uint64_t b_ready_num{0};
@@ -210,28 +260,47 @@ public:
     size_t per_thread_num{N / _PRODUCER_N_};
     static_assert(!multicast_consumers);
 
+    // one histogram per A thread, allocated upfront so that nothing is allocated while measuring
+    std::vector<LatencyHistogram> histograms(_THREAD_N_);
+
+    // each A thread discards its own leading round trips, stable detection gives up half way
+    if (warmup_.kind == WarmupPolicy::Kind::FixedMsgNum && warmup_.msg_num >= per_thread_num)
+      throw std::runtime_error("fixed warmup must be shorter than the round trips per thread");
+    std::vector<WarmupGate> warmup_gates(_THREAD_N_, WarmupGate(warmup_, per_thread_num / 2));
+    for (size_t thread_idx = 0; thread_idx < _THREAD_N_; ++thread_idx)
+      histograms[thread_idx].set_warmup(&warmup_gates[thread_idx]);
+    std::vector<PerfCounterValues> perf(2 * _THREAD_N_); // A threads first, then B threads
+    std::vector<size_t> a_iteration_nums(_THREAD_N_);
+
     std::vector<std::unique_ptr<LatencyA>> a_collection_;
     for (size_t thread_idx = 0; thread_idx < _THREAD_N_; ++thread_idx)
     {
-      a_threads_.emplace_back(
+      launch(thread_idx,
         [&, idx = thread_idx]()
         {
+          place_current_thread(a_cores_, idx);
+
           auto a = std::make_unique<LatencyA>(a_ctx_, b_ctx_); // it is important to run this before increment below!
+          ThreadPerfCounters counters;
 
           ++a_ready_num;
           while (a_ready_num.load() < _THREAD_N_ || b_ready_num.load() < _THREAD_N_)
           {
             // all A and B threads must indicate that they are ready !
+            throw_if_run_aborted();
           }
 
-          std::chrono::system_clock::time_point expected_time{};
-          auto now = std::chrono::system_clock::now();
-          start_time_ns.compare_exchange_strong(expected_time, now, std::memory_order_release);
+          uint64_t expected_tsc{0};
+          start_tsc.compare_exchange_strong(expected_tsc, TscClock::rdtsc(), std::memory_order_release);
 
           ProducerMsgCreator mc;
           ConsumerMsgProcessor mp;
-          size_t iterations_num = (*a)(idx, per_thread_num, a_ctx_, b_ctx_, mc, mp);
+          counters.start();
+          size_t iterations_num = (*a)(idx, per_thread_num, a_ctx_, b_ctx_, mc, mp, histograms[idx]);
+          counters.stop();
           a_total_iteration_num.fetch_add(iterations_num);
+          a_iteration_nums[idx] = iterations_num;
+          perf[idx] = counters.read();
 
           std::unique_lock autolock(guard);
           a_collection_.emplace_back(std::move(a));
@@ -241,32 +310,35 @@ public:
     std::vector<std::unique_ptr<LatencyB>> b_collection_;
     for (size_t thread_idx = 0; thread_idx < _THREAD_N_; ++thread_idx)
     {
-      b_threads_.emplace_back(
-        [&]()
+      launch(_THREAD_N_ + thread_idx,
+        [&, idx = thread_idx]()
         {
+          place_current_thread(b_cores_, idx);
+
           auto b = std::make_unique<LatencyB>(a_ctx_, b_ctx_); // it is important to run this before increment below!
+          ThreadPerfCounters counters;
 
           ++b_ready_num;
           while (a_ready_num.load() < _THREAD_N_ || b_ready_num.load() < _THREAD_N_)
           {
             // all A and B threads must indicate that they are ready!
+            throw_if_run_aborted();
           }
 
           ProducerMsgCreator mc;
           ConsumerMsgProcessor mp;
+          counters.start();
           size_t iterations_num = (*b)(per_thread_num, a_ctx_, b_ctx_, mc, mp);
+          counters.stop();
           b_total_iteration_num.fetch_add(iterations_num);
+          perf[_THREAD_N_ + idx] = counters.read();
 
           std::unique_lock autolock(guard);
           b_collection_.emplace_back(std::move(b));
         });
     }
 
-    for (auto& t : a_threads_)
-      t.join();
-
-    for (auto& t : b_threads_)
-      t.join();
+    join_all();
 
     if (a_total_iteration_num != b_total_iteration_num)
     {
@@ -276,15 +348,38 @@ public:
       throw std::runtime_error(ss.str());
     }
 
-    end_time_ns = std::chrono::system_clock::now();
+    end_tsc = TscClock::rdtscp();
+
+    // every A thread is measured from the moment it got warm, the round trip rates of all of
+    // them add up, without warmup this is the whole run over every round trip
+    double round_trips_per_cycle = 0;
+    size_t warmup_msg_num = 0;
+    for (size_t thread_idx = 0; thread_idx < _THREAD_N_; ++thread_idx)
+    {
+      const WarmupGate& gate = warmup_gates[thread_idx];
+      uint64_t measure_start_tsc = std::max(start_tsc.load(), gate.end_tsc());
+      if (end_tsc > measure_start_tsc)
+      {
+        round_trips_per_cycle += (a_iteration_nums[thread_idx] - gate.discarded_msg_num()) /
+          static_cast<double>(end_tsc - measure_start_tsc);
+      }
+      warmup_msg_num += gate.discarded_msg_num();
+    }
 
     LatencySingleRunResult summary;
     {
       summary.round_trip_latency_ns_AVG =
-        std::chrono::nanoseconds{end_time_ns.load() - start_time_ns.load()}.count() /
-        static_cast<double>(a_total_iteration_num);
+        round_trips_per_cycle > 0 ? 1 / (round_trips_per_cycle * TscClock::instance().cycles_per_ns()) : 0;
+      summary.warmup_msg_num = warmup_msg_num;
       summary.total_msg_num = a_total_iteration_num;
       summary.thread_num = _THREAD_N_;
+      summary.histogram = std::make_unique<LatencyHistogram>();
+      for (const LatencyHistogram& h : histograms)
+        summary.histogram->merge(h);
+
+      summary.perf = PerfCounterValues::all_available();
+      for (const PerfCounterValues& p : perf)
+        summary.perf.merge(p);
     }
 
     return summary;
@@ -17,36 +17,79 @@
 #pragma once
 
 #include "benchmark_base.h"
+#include "cpu_topology.h"
+#include "perf_counters.h"
+#include "results_store.h"
+#include "statistics.h"
 #include <iostream>
 
 template <class SingleRunResult, class BenchmarkStats>
 class BenchmarkSuiteBase
 {
 public:
-  BenchmarkSuiteBase(size_t iteration_num,
-                     std::initializer_list<std::function<std::unique_ptr<BenchmarkBase<SingleRunResult>>()>> creators)
-    : benchmark_creators_(creators), iteration_num_(iteration_num)
+  using BenchmarkCreator = std::function<std::unique_ptr<BenchmarkBase<SingleRunResult>>()>;
+  using PlacedBenchmarkCreator =
+    std::function<std::unique_ptr<BenchmarkBase<SingleRunResult>>(const PlacementScenario&)>;
+
+  BenchmarkSuiteBase(size_t iteration_num, std::vector<BenchmarkCreator> creators)
+    : benchmark_creators_(std::move(creators)), iteration_num_(iteration_num)
   {
   }
 
+  // every benchmark runs once per scenario, each scenario being a separate benchmark in the stats
+  BenchmarkSuiteBase(size_t iteration_num, const std::vector<PlacementScenario>& scenarios,
+                     std::initializer_list<PlacedBenchmarkCreator> creators)
+    : iteration_num_(iteration_num)
+  {
+    for (const PlacementScenario& scenario : scenarios)
+    {
+      for (const PlacedBenchmarkCreator& creator : creators)
+        benchmark_creators_.emplace_back([creator, scenario]() { return creator(scenario); });
+    }
+  }
+
+  // iteration_num becomes the upper bound, benchmarks stop as soon as their median is stable
+  void set_adaptive_stopping(const AdaptiveStopping& policy) { stopping_ = policy; }
+
   std::vector<BenchmarkStats> go(size_t N)
   {
     if (benchmark_creators_.empty())
       return {};
 
+    // benchmark keys are only known once a creator has been called
+    std::vector<std::string> keys(benchmark_creators_.size());
+    std::vector<bool> converged(benchmark_creators_.size(), false);
+
     std::random_device rd;
     for (size_t i = 0; i < iteration_num_; ++i)
     {
       // we want each benchmark to run exactly *iterations_num* but we
       // want them to run randomly between the benchmark calls
-      auto benchmark_creators = benchmark_creators_;
-      while (!benchmark_creators.empty())
+      std::vector<size_t> pending;
+      for (size_t creator_idx = 0; creator_idx < benchmark_creators_.size(); ++creator_idx)
       {
-        std::uniform_int_distribution<int> dist(0, benchmark_creators.size() - 1);
+        if (!converged[creator_idx])
+          pending.push_back(creator_idx);
+      }
+
+      if (pending.empty())
+        break;
+
+      while (!pending.empty())
+      {
+        std::uniform_int_distribution<int> dist(0, pending.size() - 1);
         size_t bench_idx = dist(rd);
-        auto benchmark = benchmark_creators.at(bench_idx)();
-        auto& benchmark_result = benchmark_results_[benchmark->key()];
-        benchmark_result.runs.emplace_back(benchmark->go(N));
+        size_t creator_idx = pending[bench_idx];
+        auto benchmark = benchmark_creators_.at(creator_idx)();
+        benchmark->set_worker_pool(worker_pool_);
+        keys[creator_idx] = benchmark->key();
+        auto& benchmark_result = benchmark_results_[keys[creator_idx]];
+        MemorySample before_run = MemorySample::now();
+        SingleRunResult run = benchmark->go(N);
+        // sampled before any bookkeeping of ours, so that only what the run touched is counted
+        MemorySample after_run = MemorySample::now();
+        absorb_run(keys[creator_idx], run);
+        benchmark_result.runs.push_back(std::move(run));
 
         if (benchmark_result.msg_type_name.empty())
         {
@@ -55,34 +98,127 @@ public:
           benchmark_result.name = benchmark->name();
           benchmark_result.ring_buffer_sz = benchmark->ring_buffer_sz();
           benchmark_result.msg_type_name = benchmark->msg_type_name();
+          benchmark_result.msg_size = benchmark->msg_size();
           benchmark_result.producer_num = benchmark->producer_num();
           benchmark_result.consumer_num = benchmark->consumer_num();
+          benchmark_result.producer_cores = benchmark->producer_cores();
+          benchmark_result.consumer_cores = benchmark->consumer_cores();
+          benchmark_result.placement = benchmark->placement();
+          benchmark_result.alloc_policy = benchmark->alloc_policy();
+          benchmark_result.memory = benchmark->memory_footprint();
         }
+        benchmark_result.memory.add_run(before_run, after_run);
 
-        benchmark_creators.erase(begin(benchmark_creators) + bench_idx);
+        pending.erase(begin(pending) + bench_idx);
+      }
+
+      if (stopping_.enabled())
+      {
+        for (size_t creator_idx = 0; creator_idx < benchmark_creators_.size(); ++creator_idx)
+        {
+          if (!converged[creator_idx])
+            converged[creator_idx] = stopping_.converged(run_metrics(benchmark_results_[keys[creator_idx]].runs));
+        }
       }
     }
 
     return calc_summary(benchmark_results_);
   }
 
+  // raw per-iteration samples of every benchmark which has run so far
+  std::vector<ResultRecord> records() const
+  {
+    std::vector<ResultRecord> result;
+    for (const auto& per_benchmark : benchmark_results_)
+    {
+      const BenchmarkResults& b = per_benchmark.second;
+      ResultRecord r;
+      r.key = per_benchmark.first;
+      r.name = b.name;
+      r.vendor = b.vendor;
+      r.msg_type = b.msg_type_name;
+      r.ring_buffer_sz = b.ring_buffer_sz;
+      r.producer_num = b.producer_num;
+      r.consumer_num = b.consumer_num;
+      r.placement = b.placement;
+      r.alloc_policy = b.alloc_policy;
+      r.producer_cores = format_core_list(b.producer_cores);
+      r.consumer_cores = format_core_list(b.consumer_cores);
+      r.metric = run_metric_name();
+      r.higher_is_better = run_metric_higher_is_better();
+      r.samples = run_metrics(b.runs);
+      if constexpr (requires(const SingleRunResult& run) { run.perf.values; run.total_msg_num; })
+        r.counters = per_run_perf_counters(b.runs);
+      result.push_back(std::move(r));
+    }
+
+    return result;
+  }
+
 protected:
-  std::vector<std::function<std::unique_ptr<BenchmarkBase<SingleRunResult>>()>> benchmark_creators_;
+  std::vector<BenchmarkCreator> benchmark_creators_;
 
   struct BenchmarkResults
   {
     std::string name;
     std::string vendor;
     std::string msg_type_name;
+    size_t msg_size;
     size_t producer_num;
     size_t consumer_num;
     size_t ring_buffer_sz;
+    std::vector<size_t> producer_cores;
+    std::vector<size_t> consumer_cores;
+    std::string placement;
+    std::string alloc_policy;
+    MemoryFootprint memory; // contexts of the first instance, faults of every run
     std::vector<SingleRunResult> runs;
   };
 
   using BenchmarkResultsMap = std::unordered_map<std::string /*benchmark name*/, BenchmarkResults>;
   BenchmarkResultsMap benchmark_results_;
   size_t iteration_num_;
+  AdaptiveStopping stopping_;
+  WorkerPool worker_pool_; // shared by every run of every benchmark in the suite
 
   virtual std::vector<BenchmarkStats> calc_summary(BenchmarkResultsMap& reports) = 0;
+
+  // called once per run before it is stored, lets suites fold bulky per-run data into a
+  // per-benchmark aggregate instead of keeping it around until calc_summary
+  virtual void absorb_run(const std::string& key, SingleRunResult& run) {}
+
+  // the headline number of a single run, the one adaptive stopping and run statistics look at
+  virtual double run_metric(const SingleRunResult& run) const = 0;
+  virtual std::string run_metric_name() const = 0;
+  virtual bool run_metric_higher_is_better() const { return false; }
+
+  // perf counters per message of every run, for the counters which were available in every run
+  static std::map<std::string, std::vector<double>> per_run_perf_counters(const std::vector<SingleRunResult>& runs)
+  {
+    std::map<std::string, std::vector<double>> result;
+    for (size_t i = 0; i < PERF_EVENT_N; ++i)
+    {
+      std::vector<double> values;
+      for (const SingleRunResult& run : runs)
+      {
+        if (!run.perf.available[i] || run.total_msg_num == 0)
+          break;
+        values.push_back(run.perf.values[i] / static_cast<double>(run.total_msg_num));
+      }
+
+      if (!runs.empty() && values.size() == runs.size())
+        result[PerfCountersPerMessage::NAMES[i]] = std::move(values);
+    }
+
+    return result;
+  }
+
+  std::vector<double> run_metrics(const std::vector<SingleRunResult>& runs) const
+  {
+    std::vector<double> result;
+    result.reserve(runs.size());
+    for (const SingleRunResult& run : runs)
+      result.push_back(run_metric(run));
+    return result;
+  }
 };
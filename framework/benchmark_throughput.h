@@ -18,12 +18,20 @@
 
 #include "benchmark_base.h"
 #include "benchmark_suite.h"
+#include "checked_message.h"
+#include "cpu_affinity.h"
 #include "factory.h"
+#include "perf_counters.h"
+#include "start_barrier.h"
+#include "statistics.h"
+#include "throughput_time_series.h"
+#include "tsc_clock.h"
 #include "utils.h"
 #include <atomic>
 #include <iostream>
 #include <limits>
 #include <mutex>
+#include <numeric>
 #include <stdexcept>
 #include <type_traits>
 
@@ -31,6 +39,12 @@ struct ThroughputSingleRunResult
 {
   double msg_per_second;
   size_t total_msg_num;
+  PerfCounterValues perf; // summed over all producer and consumer threads
+  std::vector<double> producer_msg_per_second; // each producer over its own active window
+  std::vector<double> consumer_msg_per_second;
+  double start_skew_ns{0}; // between the earliest and the latest released thread
+  size_t warmup_msg_num{0}; // discarded by the warmup policy, msg_per_second is measured after it
+  std::vector<ThroughputTimeSeries> consumer_series; // empty if the consumers do not stamp progress
 
   friend std::ostream& operator<<(std::ostream& o, ThroughputSingleRunResult s)
   {
@@ -47,30 +61,55 @@ struct ThroughputBenchmarkStats
   size_t iteration_num;
   size_t N;
   std::string msg_type_name;
+  size_t msg_bytes;
   size_t producer_num;
   size_t consumer_num;
+  std::string placement;
+  std::string alloc_policy;
+  std::string producer_cores;
+  std::string consumer_cores;
   size_t min;
   size_t max;
   size_t d50;
   size_t d75;
   size_t d90;
   size_t d99;
-
-  static const char* csv_header()
+  double bytes_sec; // 50_msg_sec worth of messages, compares message sizes and slot layouts
+  RunDistribution runs; // of per-run msg/sec
+  double producer_thread_msg_sec; // average over runs and threads
+  double consumer_thread_msg_sec;
+  double max_start_skew_ns;
+  double steady_msg_sec;       // median over runs, consumer side after warmup
+  double warmup_msg;           // median over runs
+  double worst_window_msg_sec; // over all runs and consumers
+  double max_window_ns;
+  double warmup_discarded_msg; // average over runs
+  MemoryFootprint memory;
+  PerfCountersPerMessage perf;
+
+  static std::string csv_header()
   {
-    return "name,vendor,ring_buffer_sz,iteration_n,msg_n,msg_type,producer_n,consumer_n,min_msg_"
-           "sec,max_msg_sec,50_msg_"
-           "sec,75_"
-           "msg_sec"
-           ",90_msg_sec,99_msg_sec\n";
+    return std::string("name,vendor,ring_buffer_sz,iteration_n,msg_n,msg_type,msg_bytes,producer_n,consumer_n,"
+                       "placement,alloc_policy,producer_cores,consumer_cores,min_msg_"
+                       "sec,max_msg_sec,50_msg_"
+                       "sec,75_"
+                       "msg_sec"
+                       ",90_msg_sec,99_msg_sec,bytes_sec,") +
+      RunDistribution::csv_header("msg_sec") +
+      ",producer_thread_msg_sec,consumer_thread_msg_sec,max_start_skew_ns,steady_msg_sec,"
+      "warmup_msg,worst_window_msg_sec,max_window_ns,warmup_discarded_msg," +
+      MemoryFootprint::csv_header() + "," + PerfCountersPerMessage::csv_header() + "\n";
   }
 
   friend std::ostream& operator<<(std::ostream& o, ThroughputBenchmarkStats s)
   {
     o << s.benchmark_name << "," << s.vendor << "," << s.ring_buffer_sz << "," << s.iteration_num
-      << "," << s.N << "," << s.msg_type_name << "," << s.producer_num << "," << s.consumer_num
-      << "," << std::fixed << std::setprecision(5) << s.min << "," << s.max << "," << s.d50 << ","
-      << s.d75 << "," << s.d90 << "," << s.d99 << "\n";
+      << "," << s.N << "," << s.msg_type_name << "," << s.msg_bytes << "," << s.producer_num << "," << s.consumer_num
+      << "," << s.placement << "," << s.alloc_policy << "," << s.producer_cores << "," << s.consumer_cores << "," << std::fixed << std::setprecision(5) << s.min << "," << s.max << "," << s.d50 << ","
+      << s.d75 << "," << s.d90 << "," << s.d99 << "," << s.bytes_sec << "," << s.runs << "," << s.producer_thread_msg_sec << ","
+      << s.consumer_thread_msg_sec << "," << s.max_start_skew_ns << "," << s.steady_msg_sec << ","
+      << s.warmup_msg << "," << s.worst_window_msg_sec << "," << s.max_window_ns << ","
+      << s.warmup_discarded_msg << "," << s.memory << "," << s.perf << "\n";
     return o;
   }
 
@@ -93,30 +132,23 @@ public:
 protected:
   std::vector<ThroughputBenchmarkStats> calc_summary(typename Base::BenchmarkResultsMap& benchmark_results) override
   {
-    if (this->iteration_num_ < 100)
-    {
-      throw std::runtime_error(
-        "please configure iteration_num >= 100, otherwise percentile stats would be highly "
-        "inaccurate");
-    }
-
     std::vector<ThroughputBenchmarkStats> result;
     for (auto& per_benchmark : benchmark_results)
     {
-      std::sort(begin(per_benchmark.second.runs), end(per_benchmark.second.runs),
-                [&](const ThroughputSingleRunResult& left, const ThroughputSingleRunResult& right)
-                {
-                  if (left.total_msg_num != right.total_msg_num)
-                  {
-                    throw std::runtime_error(
-                      std::string("benchmark [").append(per_benchmark.first).append("] had CRITICAL failures as not all messages were published/consumed - queue appear to have bugs..."));
-                  }
-
-                  return left.msg_per_second > right.msg_per_second;
-                });
+      const std::vector<ThroughputSingleRunResult>& run_stats = per_benchmark.second.runs;
+      for (const ThroughputSingleRunResult& run : run_stats)
+      {
+        if (run.total_msg_num != run_stats.front().total_msg_num)
+        {
+          throw std::runtime_error(
+            std::string("benchmark [").append(per_benchmark.first).append("] had CRITICAL failures as not all messages were published/consumed - queue appear to have bugs..."));
+        }
+      }
+
+      std::vector<double> msg_per_second = run_metrics(run_stats);
+      std::sort(begin(msg_per_second), end(msg_per_second));
 
       ThroughputBenchmarkStats s;
-      const std::vector<ThroughputSingleRunResult>& run_stats = per_benchmark.second.runs;
       {
         s.benchmark_name = per_benchmark.second.name;
         s.N = run_stats.front().total_msg_num;
@@ -126,17 +158,75 @@ protected:
         s.ring_buffer_sz = per_benchmark.second.ring_buffer_sz;
 
         s.msg_type_name = per_benchmark.second.msg_type_name;
+        s.msg_bytes = per_benchmark.second.msg_size;
         s.producer_num = per_benchmark.second.producer_num;
         s.consumer_num = per_benchmark.second.consumer_num;
+        s.placement = per_benchmark.second.placement;
+        s.alloc_policy = per_benchmark.second.alloc_policy;
+        s.producer_cores = format_core_list(per_benchmark.second.producer_cores);
+        s.consumer_cores = format_core_list(per_benchmark.second.consumer_cores);
+
+        s.min = msg_per_second.front();
+        s.max = msg_per_second.back();
+
+        // dXX is the rate XX% of runs reached, i.e. the lower tail of the distribution
+        s.d50 = quantile_sorted(msg_per_second, 0.5);
+        s.d75 = quantile_sorted(msg_per_second, 0.25);
+        s.d90 = quantile_sorted(msg_per_second, 0.1);
+        s.d99 = quantile_sorted(msg_per_second, 0.01);
+        s.bytes_sec = static_cast<double>(s.d50) * s.msg_bytes;
+        s.runs = RunDistribution::of(msg_per_second);
+
+        s.perf.totals = PerfCounterValues::all_available();
+        double producer_msg_per_second_sum{0}, consumer_msg_per_second_sum{0};
+        size_t producer_rate_num{0}, consumer_rate_num{0};
+        s.max_start_skew_ns = 0;
+        s.warmup_discarded_msg = 0;
+        for (const ThroughputSingleRunResult& run : run_stats)
+        {
+          s.perf.totals.merge(run.perf);
+          s.perf.msg_num += run.total_msg_num;
+          producer_msg_per_second_sum += std::accumulate(begin(run.producer_msg_per_second),
+                                                         end(run.producer_msg_per_second), 0.0);
+          producer_rate_num += run.producer_msg_per_second.size();
+          consumer_msg_per_second_sum += std::accumulate(begin(run.consumer_msg_per_second),
+                                                         end(run.consumer_msg_per_second), 0.0);
+          consumer_rate_num += run.consumer_msg_per_second.size();
+          s.max_start_skew_ns = std::max(s.max_start_skew_ns, run.start_skew_ns);
+          s.warmup_discarded_msg += run.warmup_msg_num / static_cast<double>(run_stats.size());
+        }
+
+        s.producer_thread_msg_sec = producer_rate_num ? producer_msg_per_second_sum / producer_rate_num : 0;
+        s.consumer_thread_msg_sec = consumer_rate_num ? consumer_msg_per_second_sum / consumer_rate_num : 0;
+        s.memory = per_benchmark.second.memory;
+
+        // a run is as steady as its slowest consumer, and warm once its last consumer is
+        std::vector<double> steady_msg_sec, warmup_msg;
+        s.worst_window_msg_sec = std::numeric_limits<double>::max();
+        s.max_window_ns = 0;
+        for (const ThroughputSingleRunResult& run : run_stats)
+        {
+          if (run.consumer_series.empty() || run.consumer_series.front().window_msg_per_second.empty())
+            continue;
 
-        s.min = run_stats.back().msg_per_second;
-        s.max = run_stats.front().msg_per_second;
+          double run_steady = std::numeric_limits<double>::max();
+          size_t run_warmup = 0;
+          for (const ThroughputTimeSeries& series : run.consumer_series)
+          {
+            run_steady = std::min(run_steady, series.steady_msg_per_second);
+            run_warmup = std::max(run_warmup, series.warmup_msg_num());
+            s.worst_window_msg_sec = std::min(s.worst_window_msg_sec, series.worst_window_msg_per_second);
+            s.max_window_ns = std::max(s.max_window_ns, series.max_window_ns);
+          }
+
+          steady_msg_sec.push_back(run_steady);
+          warmup_msg.push_back(run_warmup);
+        }
 
-        // a bit crude percentile count, but it would work if iteration num is high enough >= 100
-        s.d50 = run_stats[run_stats.size() * 0.5].msg_per_second;
-        s.d75 = run_stats[run_stats.size() * 0.75].msg_per_second;
-        s.d90 = run_stats[run_stats.size() * 0.9].msg_per_second;
-        s.d99 = run_stats[run_stats.size() * 0.99].msg_per_second;
+        if (steady_msg_sec.empty())
+          s.worst_window_msg_sec = 0;
+        s.steady_msg_sec = steady_msg_sec.empty() ? 0 : median(steady_msg_sec);
+        s.warmup_msg = warmup_msg.empty() ? 0 : median(warmup_msg);
 
         result.push_back(s);
       }
@@ -144,6 +234,10 @@ protected:
 
     return result;
   }
+
+  double run_metric(const ThroughputSingleRunResult& run) const override { return run.msg_per_second; }
+  std::string run_metric_name() const override { return "msg_sec"; }
+  bool run_metric_higher_is_better() const override { return true; }
 };
 
 template <class T, class BenchmarkContext, std::size_t _PRODUCER_N_, std::size_t _CONSUMER_N_,
@@ -152,44 +246,72 @@ class ThroughputBenchmark : public BenchmarkBase<ThroughputSingleRunResult>
 {
   using Base = BenchmarkBase<ThroughputSingleRunResult>;
 
-  std::deque<std::jthread> producers_threads_;
-  std::deque<std::jthread> consumers_threads_;
-
   std::vector<std::size_t> producer_cores_;
   std::vector<std::size_t> consumer_cores_;
+  size_t progress_stamp_every_;
+  WarmupPolicy warmup_;
 
+  AllocationPolicyScope context_alloc_scope_; // must stay before the contexts
+  MemoryProbe context_probe_;                 // must stay right before the contexts
   BenchmarkContext ctx_;
 
-  static_assert(std::atomic<std::chrono::system_clock::time_point>::is_always_lock_free);
-
 public:
+  using context_type = BenchmarkContext;
+  static constexpr size_t PRODUCER_THREAD_N = _PRODUCER_N_;
+  static constexpr size_t CONSUMER_THREAD_N = _CONSUMER_N_;
+
+  ThroughputBenchmark(const std::string& name, const BenchmarkParams& params)
+    : Base(name, BenchmarkContext::VENDOR, params.ring_buffer_sz, params.placement.name),
+      producer_cores_(params.placement.producer_cores),
+      consumer_cores_(params.placement.consumer_cores),
+      progress_stamp_every_(params.progress_stamp_every),
+      warmup_(params.warmup),
+      context_alloc_scope_(params.context_alloc()),
+      ctx_(params.ring_buffer_sz)
+  {
+    check_core_list(producer_cores_, _PRODUCER_N_, "producer");
+    check_core_list(consumer_cores_, _CONSUMER_N_, "consumer");
+    set_memory_footprint(context_probe_.finish(params.ring_buffer_sz));
+    set_alloc_policy(params, context_alloc_scope_);
+
+    if constexpr (requires { ProduceAllMessage::validate(ctx_); })
+      ProduceAllMessage::validate(ctx_);
+
+    TscClock::instance(); // calibrate outside of the measured window
+  }
+
   ThroughputBenchmark(const std::string& name, size_t ring_buffer_sz,
                       const std::vector<std::size_t>& producer_cores = {},
-                      const std::vector<std::size_t>& consumer_cores = {})
-    : Base(name, BenchmarkContext::VENDOR, ring_buffer_sz),
-      producer_cores_(producer_cores),
-      consumer_cores_(consumer_cores),
-      ctx_(ring_buffer_sz)
+                      const std::vector<std::size_t>& consumer_cores = {},
+                      const std::string& placement = "")
+    : ThroughputBenchmark(name, BenchmarkParams{ring_buffer_sz,
+                                                 PlacementScenario{placement, producer_cores, consumer_cores}})
   {
   }
 
   std::string msg_type_name() const override { return typeid(T).name(); }
+  size_t msg_size() const override { return sizeof(T); }
   size_t producer_num() const override { return _PRODUCER_N_; }
   size_t consumer_num() const override { return _CONSUMER_N_; }
+  std::vector<size_t> producer_cores() const override { return producer_cores_; }
+  std::vector<size_t> consumer_cores() const override { return consumer_cores_; }
 
   ThroughputSingleRunResult go(size_t N) override
   {
     using ProducerMsgCreator = typename ProduceAllMessage::message_creator;
     using ConsumerMsgProcessor = typename ConsumeAllMessage::message_processor;
 
-    std::atomic<std::chrono::system_clock::time_point> start_time_ns{};
-    std::atomic<std::chrono::system_clock::time_point> end_time_ns;
-
     std::mutex guard;
-    std::atomic_uint64_t producers_ready_num{0};
     std::atomic_uint64_t consumers_ready_num{0};
     std::atomic_uint64_t total_msg_published{0};
     std::atomic_uint64_t total_msg_consumed{0};
+    TscStartBarrier start_barrier(_PRODUCER_N_ + _CONSUMER_N_, &run_aborted());
+
+    // producers first, then consumers
+    std::vector<PerfCounterValues> perf(_PRODUCER_N_ + _CONSUMER_N_);
+    std::vector<ThreadActiveWindow> windows(_PRODUCER_N_ + _CONSUMER_N_);
+    std::vector<ProgressStamps> progress(_CONSUMER_N_);
+    std::vector<SequenceCheck> sequence_checks(_CONSUMER_N_); // of validating processors only
 
     size_t per_consumer_num;
     size_t total_consume_num;
@@ -207,51 +329,74 @@ public:
     total_consume_num = per_consumer_num * _CONSUMER_N_;
     for (size_t producer_id = 0; producer_id < _PRODUCER_N_; ++producer_id)
     {
-      producers_threads_.emplace_back(
-        [&]()
+      launch(producer_id,
+        [&, producer_id]()
         {
-          while (consumers_ready_num.load() < _CONSUMER_N_)
+          place_current_thread(producer_cores_, producer_id);
+
+          // consumers have to be attached to the queue before anything gets published
+          while (consumers_ready_num.load(std::memory_order_acquire) < _CONSUMER_N_)
           {
-            // all producers and consumers must indicate that they are ready!
+            throw_if_run_aborted();
+            _mm_pause();
           }
 
+          ThreadPerfCounters counters;
           ProducerMsgCreator mc;
+          if constexpr (requires { mc.set_producer_id(producer_id); })
+            mc.set_producer_id(producer_id);
           ProduceAllMessage msg_producer(per_producer_num, ctx_, mc);
-          ++producers_ready_num;
-
-          while (producers_ready_num.load() < _PRODUCER_N_)
-          {
-            // all producers and consumers must indicate that they are ready!
-          }
-
-          {
-            std::unique_lock autolock(guard);
-            if (start_time_ns.load() == std::chrono::system_clock::time_point{})
-              start_time_ns.store(std::chrono::system_clock::now());
-          }
 
+          ThreadActiveWindow& window = windows[producer_id];
+          window.start_tsc = start_barrier.arrive_and_wait();
+          counters.start(); // after the barrier, so that neither the deadline spin nor late threads count
           size_t published_num = msg_producer();
+          window.stop_tsc = TscClock::rdtscp();
+          counters.stop();
+          window.msg_num = published_num;
           total_msg_published.fetch_add(published_num);
+          perf[producer_id] = counters.read();
         });
     }
 
     size_t max_consumed_num_per_consumer{std::numeric_limits<size_t>::min()};
     for (size_t consumer_id = 0; consumer_id < _CONSUMER_N_; ++consumer_id)
     {
-      consumers_threads_.emplace_back(
-        [&]()
+      launch(_PRODUCER_N_ + consumer_id,
+        [&, consumer_id]()
         {
-          ConsumerMsgProcessor mp;
-          ConsumeAllMessage msg_consumer(per_consumer_num, ctx_, mp);
-          ++consumers_ready_num;
+          place_current_thread(consumer_cores_, consumer_id);
 
-          while (producers_ready_num.load() < _PRODUCER_N_ || consumers_ready_num.load() < _CONSUMER_N_)
+          ThreadPerfCounters counters;
+          ConsumerMsgProcessor mp;
+          if constexpr (requires { mp.reserve_sequence_check(_PRODUCER_N_, per_producer_num); })
+            mp.reserve_sequence_check(_PRODUCER_N_, per_producer_num);
+          ProgressStamps& stamps = progress[consumer_id];
+          auto msg_consumer = [&]()
           {
-            // all producers and consumers must indicate that they are ready!
-          }
-
+            // adapters which cannot stamp progress simply get no time series
+            if constexpr (std::is_constructible_v<ConsumeAllMessage, size_t, BenchmarkContext&,
+                                                  ConsumerMsgProcessor&, ProgressStamps&>)
+            {
+              stamps.reset(per_consumer_num, progress_stamp_every_);
+              return ConsumeAllMessage(per_consumer_num, ctx_, mp, stamps);
+            }
+            else
+              return ConsumeAllMessage(per_consumer_num, ctx_, mp);
+          }();
+          consumers_ready_num.fetch_add(1, std::memory_order_release);
+
+          ThreadActiveWindow& window = windows[_PRODUCER_N_ + consumer_id];
+          window.start_tsc = start_barrier.arrive_and_wait();
+          counters.start();
           auto actual_consumed_num = msg_consumer();
+          window.stop_tsc = TscClock::rdtscp();
+          counters.stop();
+          window.msg_num = actual_consumed_num;
           total_msg_consumed.fetch_add(actual_consumed_num);
+          perf[_PRODUCER_N_ + consumer_id] = counters.read();
+          if constexpr (requires { mp.sequence_check(); })
+            sequence_checks[consumer_id] = mp.sequence_check();
           if (actual_consumed_num != per_consumer_num)
           {
             std::stringstream ss;
@@ -266,11 +411,17 @@ public:
         });
     }
 
-    for (auto& t : producers_threads_)
-      t.join();
+    join_all();
 
-    for (auto& t : consumers_threads_)
-      t.join();
+    if constexpr (requires(ConsumerMsgProcessor& mp) { mp.sequence_check(); })
+    {
+      SequenceCheck check = SequenceCheck::merge(sequence_checks, multicast_consumers);
+      if (!check.ok())
+      {
+        throw std::runtime_error(std::string("benchmark [").append(name()).append("/").append(vendor())
+                                   .append("] failed message validation: ").append(check.to_string()));
+      }
+    }
 
     if constexpr (std::is_same_v<ConsumerMsgProcessor, ConsumeAndStore<T>>)
     {
@@ -295,12 +446,103 @@ public:
       throw std::runtime_error(ss.str());
     }
 
+    // the run is measured from the moment every thread is active until the last message got
+    // consumed, so neither a late start of some thread nor thread teardown gets into the number
+    uint64_t first_start_tsc{std::numeric_limits<uint64_t>::max()}, last_start_tsc{0}, end_tsc{0};
+    for (const ThreadActiveWindow& w : windows)
+    {
+      first_start_tsc = std::min(first_start_tsc, w.start_tsc);
+      last_start_tsc = std::max(last_start_tsc, w.start_tsc);
+    }
+
+    for (size_t consumer_id = 0; consumer_id < _CONSUMER_N_; ++consumer_id)
+      end_tsc = std::max(end_tsc, windows[_PRODUCER_N_ + consumer_id].stop_tsc);
+
     ThroughputSingleRunResult summary;
-    end_time_ns = std::chrono::system_clock::now();
-    summary.msg_per_second = static_cast<double>(total_msg_published) /
-      (std::chrono::nanoseconds{end_time_ns.load() - start_time_ns.load()}.count() /
-       static_cast<double>(NANO_PER_SEC));
     summary.total_msg_num = total_msg_published;
+
+    std::vector<std::vector<uint64_t>> stamps(_CONSUMER_N_);
+    for (size_t consumer_id = 0; consumer_id < _CONSUMER_N_; ++consumer_id)
+    {
+      if (progress[consumer_id].stamp_every() != 0)
+      {
+        stamps[consumer_id] = progress[consumer_id].stamps();
+        summary.consumer_series.push_back(ThroughputTimeSeries::from_stamps(
+          windows[_PRODUCER_N_ + consumer_id].start_tsc, stamps[consumer_id],
+          progress[consumer_id].stamp_every()));
+      }
+    }
+
+    // warmup is cut off at a whole progress window, adapters which do not stamp their progress
+    // are measured from the start
+    uint64_t measure_start_tsc = last_start_tsc;
+    double measured_msg_num = total_msg_published;
+    if (size_t warmup_window_num = warmup_window_num_of(summary.consumer_series, per_consumer_num))
+    {
+      for (const std::vector<uint64_t>& consumer_stamps : stamps)
+        measure_start_tsc = std::max(measure_start_tsc, consumer_stamps[warmup_window_num - 1]);
+
+      size_t per_consumer_warmup_num = warmup_window_num * progress_stamp_every_;
+      measured_msg_num = total_msg_published *
+        static_cast<double>(per_consumer_num - per_consumer_warmup_num) / per_consumer_num;
+      summary.warmup_msg_num = total_msg_published - static_cast<size_t>(measured_msg_num);
+    }
+
+    summary.msg_per_second = measured_msg_num /
+      (TscClock::instance().cycles_to_ns(end_tsc - measure_start_tsc) / static_cast<double>(NANO_PER_SEC));
+    summary.start_skew_ns = TscClock::instance().cycles_to_ns(last_start_tsc - first_start_tsc);
+    for (size_t producer_id = 0; producer_id < _PRODUCER_N_; ++producer_id)
+      summary.producer_msg_per_second.push_back(windows[producer_id].msg_per_second());
+    for (size_t consumer_id = 0; consumer_id < _CONSUMER_N_; ++consumer_id)
+      summary.consumer_msg_per_second.push_back(windows[_PRODUCER_N_ + consumer_id].msg_per_second());
+    summary.perf = PerfCounterValues::all_available();
+    for (const PerfCounterValues& p : perf)
+      summary.perf.merge(p);
     return summary;
   }
+
+private:
+  // the same number of leading windows is discarded for every consumer: the most any of them needs
+  size_t warmup_window_num_of(const std::vector<ThroughputTimeSeries>& series, size_t per_consumer_num) const
+  {
+    if (!warmup_.enabled() || series.size() != _CONSUMER_N_)
+      return 0;
+
+    size_t window_num = std::numeric_limits<size_t>::max();
+    for (const ThroughputTimeSeries& consumer_series : series)
+      window_num = std::min(window_num, consumer_series.window_msg_per_second.size());
+    if (window_num == 0)
+      return 0;
+
+    if (warmup_.kind == WarmupPolicy::Kind::FixedMsgNum)
+    {
+      if (warmup_.msg_num >= per_consumer_num)
+        throw std::runtime_error("fixed warmup must be shorter than the messages per consumer");
+
+      // at least one window has to be left to measure, cutting less than asked would be a lie
+      size_t warmup_window_num =
+        (warmup_.msg_num + progress_stamp_every_ - 1) / progress_stamp_every_;
+      if (warmup_window_num > window_num - 1)
+      {
+        throw std::runtime_error("fixed warmup of " + std::to_string(warmup_.msg_num) +
+                                 " messages leaves no whole window of " +
+                                 std::to_string(progress_stamp_every_) + " messages to measure");
+      }
+
+      return warmup_window_num;
+    }
+
+    size_t max_window_num = window_num / 2;
+    if (warmup_.msg_num)
+      max_window_num = std::min(max_window_num, warmup_.msg_num / progress_stamp_every_);
+
+    size_t result = 0;
+    for (const ThroughputTimeSeries& consumer_series : series)
+    {
+      result = std::max(result, detect_warmup_windows(consumer_series.window_msg_per_second,
+                                                      warmup_.tolerance, warmup_.stable_window_num));
+    }
+
+    return std::min(result, max_window_num);
+  }
 };
@@ -0,0 +1,233 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Message of checked runs: the payload of the benchmark's own message type framed by the id of
+// its producer, a per-producer sequence number and a checksum over all of it. The sequence number
+// comes first and the checksum last, so a slot read while it is being overwritten fails the
+// checksum whatever the payload looks like.
+template <class T>
+struct CheckedMessage
+{
+  static_assert(std::has_unique_object_representations_v<T>,
+                "payload must not have padding, which would make checksums of equal messages differ");
+
+  uint64_t seq_num;
+  uint32_t producer_id;
+  T payload;
+  uint64_t checksum;
+
+  uint64_t expected_checksum() const
+  {
+    uint64_t h = (seq_num ^ 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ producer_id) * 0x94D049BB133111EBull;
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(&payload);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= sizeof(T); i += sizeof(uint64_t))
+    {
+      uint64_t word;
+      std::memcpy(&word, p + i, sizeof(word));
+      h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+    }
+    for (; i < sizeof(T); ++i)
+      h = (h ^ p[i]) * 0x100000001B3ull;
+    return h ^ (h >> 29);
+  }
+
+  bool intact() const { return checksum == expected_checksum(); }
+};
+
+// What validating consumers saw. Every consumer keeps, per producer, a bitmap of the sequence
+// numbers it got, so the hot path is a bit test and set. merge() turns the bitmaps of all
+// consumers into lost and duplicated messages.
+class SequenceCheck
+{
+  struct ProducerSequence
+  {
+    std::vector<uint64_t> seen; // bit per sequence number
+    uint64_t max_seq_num{0};
+    bool any{false};
+  };
+
+  std::vector<ProducerSequence> producers_;
+
+  // sequence numbers below the highest one which are not in the bitmap
+  static size_t holes_of(const ProducerSequence& p)
+  {
+    if (!p.any)
+      return 0;
+
+    size_t seen_num = 0;
+    for (uint64_t word : p.seen)
+      seen_num += std::popcount(word);
+    return p.max_seq_num + 1 - seen_num;
+  }
+
+public:
+  size_t torn_num{0};      // checksum mismatches
+  size_t duplicate_num{0}; // by the same consumer, or by several anycast consumers
+  size_t reorder_num{0};   // per-producer FIFO violations, i.e. older than what was already seen
+  size_t lost_num{0};      // found by merge()
+
+  // sizes the bitmaps up front, so that on_message() does not grow them within the measured loop
+  void reserve(size_t producer_num, size_t per_producer_num)
+  {
+    producers_.resize(std::max(producers_.size(), producer_num));
+    for (ProducerSequence& p : producers_)
+      p.seen.resize(std::max(p.seen.size(), (per_producer_num + 63) / 64));
+  }
+
+  void on_torn() { ++torn_num; }
+
+  void on_message(uint32_t producer_id, uint64_t seq_num)
+  {
+    if (producer_id >= producers_.size()) [[unlikely]]
+      producers_.resize(producer_id + 1);
+
+    ProducerSequence& p = producers_[producer_id];
+    size_t word = seq_num / 64;
+    uint64_t bit = uint64_t(1) << (seq_num % 64);
+    if (word >= p.seen.size()) [[unlikely]]
+      p.seen.resize(std::max(word + 1, p.seen.size() * 2));
+
+    if (p.seen[word] & bit)
+    {
+      ++duplicate_num;
+      return;
+    }
+
+    p.seen[word] |= bit;
+    if (p.any && seq_num < p.max_seq_num)
+      ++reorder_num;
+    p.max_seq_num = p.any ? std::max(p.max_seq_num, seq_num) : seq_num;
+    p.any = true;
+  }
+
+  // Multicast consumers must each get every producer's sequence, anycast consumers split it among
+  // themselves. Either way what arrived of a producer must be a prefix of its sequence: messages
+  // left in the queue because per-consumer targets got rounded down are always the newest ones.
+  static SequenceCheck merge(const std::vector<SequenceCheck>& consumers, bool multicast)
+  {
+    SequenceCheck result;
+    for (const SequenceCheck& c : consumers)
+    {
+      result.torn_num += c.torn_num;
+      result.duplicate_num += c.duplicate_num;
+      result.reorder_num += c.reorder_num;
+      if (multicast)
+      {
+        for (const ProducerSequence& p : c.producers_)
+          result.lost_num += holes_of(p);
+        continue;
+      }
+
+      if (c.producers_.size() > result.producers_.size())
+        result.producers_.resize(c.producers_.size());
+      for (size_t producer_id = 0; producer_id < c.producers_.size(); ++producer_id)
+      {
+        const ProducerSequence& from = c.producers_[producer_id];
+        ProducerSequence& to = result.producers_[producer_id];
+        if (!from.any)
+          continue;
+
+        if (from.seen.size() > to.seen.size())
+          to.seen.resize(from.seen.size());
+        for (size_t word = 0; word < from.seen.size(); ++word)
+        {
+          result.duplicate_num += std::popcount(to.seen[word] & from.seen[word]);
+          to.seen[word] |= from.seen[word];
+        }
+        to.max_seq_num = to.any ? std::max(to.max_seq_num, from.max_seq_num) : from.max_seq_num;
+        to.any = true;
+      }
+    }
+
+    for (const ProducerSequence& p : result.producers_)
+      result.lost_num += holes_of(p);
+    return result;
+  }
+
+  bool ok() const { return torn_num == 0 && duplicate_num == 0 && reorder_num == 0 && lost_num == 0; }
+
+  std::string to_string() const
+  {
+    std::stringstream ss;
+    ss << "torn=" << torn_num << ",lost=" << lost_num << ",duplicate=" << duplicate_num
+       << ",reorder=" << reorder_num;
+    return ss.str();
+  }
+};
+
+// Wraps the benchmark's own message creator, the benchmark hands it the id of its producer.
+template <class T, class MessageCreator>
+struct ProduceChecked
+{
+  MessageCreator creator;
+  uint32_t producer_id{0};
+  uint64_t seq_num{0};
+
+  void set_producer_id(size_t id) { producer_id = static_cast<uint32_t>(id); }
+
+  CheckedMessage<T> operator()()
+  {
+    CheckedMessage<T> m;
+    m.seq_num = seq_num++;
+    m.producer_id = producer_id;
+    m.payload = creator();
+    m.checksum = m.expected_checksum();
+    return m;
+  }
+};
+
+// Validates every message before passing its payload on to the benchmark's own processor, the
+// benchmark collects sequence_check() of every consumer once the run is over.
+template <class T, class MessageProcessor>
+struct ConsumeChecked
+{
+  MessageProcessor processor;
+  SequenceCheck check;
+
+  void operator()(const CheckedMessage<T>& m)
+  {
+    if (!m.intact()) [[unlikely]]
+    {
+      check.on_torn();
+      return;
+    }
+
+    check.on_message(m.producer_id, m.seq_num);
+    processor(m.payload);
+  }
+
+  void reserve_sequence_check(size_t producer_num, size_t per_producer_num)
+  {
+    check.reserve(producer_num, per_producer_num);
+  }
+
+  const SequenceCheck& sequence_check() const { return check; }
+};
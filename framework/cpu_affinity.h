@@ -0,0 +1,187 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// the core the calling thread is pinned to, threads of the suite's worker pool run many benchmarks
+// so they skip the syscalls when they are already where they should be
+inline thread_local std::optional<size_t> current_thread_core;
+
+// affinity of the process as it was started, i.e. what unpinned threads are allowed to run on
+inline const cpu_set_t& initial_process_affinity()
+{
+  static const cpu_set_t cpu_set = []()
+  {
+    cpu_set_t s;
+    CPU_ZERO(&s);
+    if (sched_getaffinity(getpid(), sizeof(s), &s) != 0)
+      throw std::runtime_error(std::string("could not read process affinity: ") + std::strerror(errno));
+    return s;
+  }();
+  return cpu_set;
+}
+
+// pins the calling thread to a single core and reads the affinity mask back to make sure the
+// kernel actually applied it, e.g. it would not if the core is outside of our cpuset
+inline void pin_current_thread(size_t core)
+{
+  if (current_thread_core == core)
+    return;
+
+  initial_process_affinity(); // capture it before the first thread gets pinned
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(core, &cpu_set);
+  if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+  {
+    std::stringstream ss;
+    ss << "could not pin thread to core [" << core << "]: " << std::strerror(errno);
+    throw std::runtime_error(ss.str());
+  }
+
+  cpu_set_t actual_cpu_set;
+  CPU_ZERO(&actual_cpu_set);
+  if (sched_getaffinity(0, sizeof(actual_cpu_set), &actual_cpu_set) != 0 ||
+      CPU_COUNT(&actual_cpu_set) != 1 || !CPU_ISSET(core, &actual_cpu_set))
+  {
+    std::stringstream ss;
+    ss << "thread affinity read back does not match requested core [" << core << "]";
+    throw std::runtime_error(ss.str());
+  }
+
+  current_thread_core = core;
+}
+
+// lets the calling thread, and the threads it starts from now on, run on any of the given cores
+inline void restrict_current_thread(const std::vector<size_t>& cores)
+{
+  initial_process_affinity(); // capture it before the first thread gets restricted
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (size_t core : cores)
+    CPU_SET(core, &cpu_set);
+  if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+  {
+    throw std::runtime_error(std::string("could not restrict thread to its cores: ") +
+                             std::strerror(errno));
+  }
+
+  current_thread_core.reset();
+}
+
+// lets a previously pinned thread run anywhere the process is allowed to again
+inline void unpin_current_thread()
+{
+  if (!current_thread_core)
+    return;
+
+  if (sched_setaffinity(0, sizeof(cpu_set_t), &initial_process_affinity()) != 0)
+    throw std::runtime_error(std::string("could not unpin thread: ") + std::strerror(errno));
+
+  current_thread_core.reset();
+}
+
+// checks that there is an allowed core for each of the thread_num threads and drops the extra
+// ones, so that a bad core list fails before any benchmark thread starts waiting for the others
+inline void check_core_list(std::vector<size_t>& cores, size_t thread_num, const std::string& side)
+{
+  if (cores.empty())
+    return;
+
+  if (cores.size() < thread_num)
+    throw std::runtime_error("not enough " + side + " cores provided to pin every " + side + " thread");
+  cores.resize(thread_num);
+
+  for (size_t core : cores)
+  {
+    if (core >= CPU_SETSIZE || !CPU_ISSET(core, &initial_process_affinity()))
+      throw std::runtime_error("core [" + std::to_string(core) + "] is not available to this process");
+  }
+}
+
+// pins the calling thread to cores[idx], or unpins it if an empty list says it must not be pinned
+inline void place_current_thread(const std::vector<size_t>& cores, size_t idx)
+{
+  if (cores.empty())
+    unpin_current_thread();
+  else
+    pin_current_thread(cores.at(idx));
+}
+
+// parses core lists in the same format as /sys/devices/system/cpu/online, e.g. "0,2,4-7"
+inline std::vector<size_t> parse_core_list(const std::string& s)
+{
+  std::vector<size_t> cores;
+  std::stringstream ss(s);
+  std::string token;
+  while (std::getline(ss, token, ','))
+  {
+    if (token.empty())
+      continue;
+
+    size_t dash = token.find('-');
+    size_t first = std::stoul(token.substr(0, dash));
+    size_t last = dash == std::string::npos ? first : std::stoul(token.substr(dash + 1));
+    if (last < first)
+      throw std::runtime_error("invalid core range [" + token + "]");
+
+    for (size_t core = first; core <= last; ++core)
+      cores.push_back(core);
+  }
+
+  return cores;
+}
+
+// ';' separated so that it can be put into a single CSV column
+inline std::string format_core_list(const std::vector<size_t>& cores)
+{
+  if (cores.empty())
+    return "none";
+
+  std::string result;
+  for (size_t i = 0; i < cores.size(); ++i)
+  {
+    if (i > 0)
+      result += ';';
+    result += std::to_string(cores[i]);
+  }
+
+  return result;
+}
+
+// looks up "--name 0,2,4-7" among the command line arguments, returns empty list if not present
+inline std::vector<size_t> core_list_arg(int argc, char** argv, const std::string& name)
+{
+  for (int i = 1; i + 1 < argc; ++i)
+  {
+    if (name == argv[i])
+      return parse_core_list(argv[i + 1]);
+  }
+
+  return {};
+}
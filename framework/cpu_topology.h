@@ -0,0 +1,428 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "cpu_affinity.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+struct PlacementScenario
+{
+  std::string name;
+  std::vector<size_t> producer_cores;
+  std::vector<size_t> consumer_cores;
+  int memory_node{-1}; // NUMA node the ring buffers get bound to, -1 leaves it to the alloc policy
+};
+
+struct PhysicalCore
+{
+  size_t package_id;
+  size_t l3_id;                // lowest cpu sharing the same L3, package id if there is no L3 info
+  size_t numa_node{0};
+  std::vector<size_t> threads; // logical cpus, i.e. SMT siblings, sorted
+};
+
+class CpuTopology
+{
+  std::vector<PhysicalCore> cores_;
+
+  static std::string read_line(const std::string& path)
+  {
+    std::ifstream f(path);
+    std::string line;
+    std::getline(f, line);
+    return line;
+  }
+
+  // cpuN/nodeM links only exist on NUMA enabled kernels, everything is node 0 otherwise
+  static size_t read_numa_node(const std::string& cpu_dir)
+  {
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(cpu_dir, ec))
+    {
+      std::string name = entry.path().filename().string();
+      if (name.size() > 4 && name.rfind("node", 0) == 0 &&
+          name.find_first_not_of("0123456789", 4) == std::string::npos)
+        return std::stoul(name.substr(4));
+    }
+
+    return 0;
+  }
+
+public:
+  CpuTopology() = default;
+  explicit CpuTopology(std::vector<PhysicalCore> cores) : cores_(std::move(cores)) {}
+
+  // the online cpus this process may run on, a core whose SMT siblings are partly outside of
+  // the process affinity only keeps the allowed ones
+  static CpuTopology load(const std::string& sysfs_root = "/sys/devices/system/cpu")
+  {
+    std::vector<size_t> online = parse_core_list(read_line(sysfs_root + "/online"));
+    std::map<size_t /*first sibling*/, PhysicalCore> cores;
+    for (size_t cpu : online)
+    {
+      // under taskset or a cpuset only part of the machine is ours, plan on that part alone
+      if (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &initial_process_affinity()))
+        continue;
+
+      const std::string cpu_dir = sysfs_root + "/cpu" + std::to_string(cpu);
+      std::vector<size_t> siblings =
+        parse_core_list(read_line(cpu_dir + "/topology/thread_siblings_list"));
+      if (siblings.empty())
+        siblings.push_back(cpu);
+
+      std::string package = read_line(cpu_dir + "/topology/physical_package_id");
+      size_t package_id = package.empty() ? 0 : std::stoul(package);
+
+      std::optional<size_t> l3_id;
+      for (size_t idx = 0;; ++idx)
+      {
+        const std::string cache_dir = cpu_dir + "/cache/index" + std::to_string(idx);
+        std::string level = read_line(cache_dir + "/level");
+        if (level.empty())
+          break;
+
+        if (level == "3")
+        {
+          std::vector<size_t> shared = parse_core_list(read_line(cache_dir + "/shared_cpu_list"));
+          if (!shared.empty())
+            l3_id = *std::min_element(begin(shared), end(shared));
+          break;
+        }
+      }
+
+      size_t core_key = *std::min_element(begin(siblings), end(siblings));
+      PhysicalCore& core = cores[core_key];
+      core.package_id = package_id;
+      core.l3_id = l3_id.value_or(package_id);
+      core.numa_node = read_numa_node(cpu_dir);
+      core.threads.push_back(cpu);
+    }
+
+    std::vector<PhysicalCore> result;
+    for (auto& [key, core] : cores)
+    {
+      std::sort(begin(core.threads), end(core.threads));
+      result.push_back(std::move(core));
+    }
+
+    return CpuTopology(std::move(result));
+  }
+
+  const std::vector<PhysicalCore>& cores() const { return cores_; }
+
+  std::set<size_t> l3_domains() const
+  {
+    std::set<size_t> result;
+    for (const PhysicalCore& c : cores_)
+      result.insert(c.l3_id);
+    return result;
+  }
+
+  std::set<size_t> packages() const
+  {
+    std::set<size_t> result;
+    for (const PhysicalCore& c : cores_)
+      result.insert(c.package_id);
+    return result;
+  }
+
+  std::set<size_t> numa_nodes() const
+  {
+    std::set<size_t> result;
+    for (const PhysicalCore& c : cores_)
+      result.insert(c.numa_node);
+    return result;
+  }
+
+  // logical cpus of every core, sorted
+  std::vector<size_t> cpus() const
+  {
+    std::vector<size_t> result;
+    for (const PhysicalCore& c : cores_)
+      result.insert(end(result), begin(c.threads), end(c.threads));
+    std::sort(begin(result), end(result));
+    return result;
+  }
+
+  // disjoint parts of the machine which share no L3, or no package at all with by_package
+  std::vector<CpuTopology> partition(bool by_package) const
+  {
+    std::map<size_t, std::vector<PhysicalCore>> parts;
+    for (const PhysicalCore& c : cores_)
+      parts[by_package ? c.package_id : c.l3_id].push_back(c);
+
+    std::vector<CpuTopology> result;
+    for (auto& [id, cores] : parts)
+      result.emplace_back(std::move(cores));
+    return result;
+  }
+};
+
+// Generates named producer/consumer placements for the machine's topology. Placements which
+// the machine cannot satisfy, e.g. cross_socket on a single socket box, are simply not generated.
+//  - smt_sibling : consumer i runs on the SMT sibling of producer i, all within one L3
+//  - same_ccx    : every thread gets its own physical core, all sharing one L3
+//  - cross_ccx   : producers and consumers sit on different L3 domains of the same package
+//  - cross_socket: producers and consumers sit on different packages
+// numa_matrix() is not part of plan() as it grows with the cube of the node number.
+class PlacementPlanner
+{
+  CpuTopology topology_;
+
+  template <class Predicate>
+  std::vector<const PhysicalCore*> cores_where(Predicate&& predicate, size_t min_threads = 1) const
+  {
+    std::vector<const PhysicalCore*> result;
+    for (const PhysicalCore& c : topology_.cores())
+    {
+      if (c.threads.size() >= min_threads && predicate(c))
+        result.push_back(&c);
+    }
+    return result;
+  }
+
+  static std::vector<size_t> first_threads(const std::vector<const PhysicalCore*>& cores,
+                                           size_t offset, size_t n)
+  {
+    std::vector<size_t> result;
+    for (size_t i = offset; i < offset + n; ++i)
+      result.push_back(cores[i]->threads.front());
+    return result;
+  }
+
+public:
+  explicit PlacementPlanner(CpuTopology topology) : topology_(std::move(topology)) {}
+
+  std::optional<PlacementScenario> smt_sibling(size_t producer_n, size_t consumer_n) const
+  {
+    size_t required = std::max(producer_n, consumer_n);
+    for (size_t l3 : topology_.l3_domains())
+    {
+      auto cores = cores_where([&](const PhysicalCore& c) { return c.l3_id == l3; }, 2);
+      if (cores.size() < required)
+        continue;
+
+      PlacementScenario s{"smt_sibling", {}, {}};
+      for (size_t i = 0; i < producer_n; ++i)
+        s.producer_cores.push_back(cores[i]->threads[0]);
+      for (size_t i = 0; i < consumer_n; ++i)
+        s.consumer_cores.push_back(cores[i]->threads[1]);
+      return s;
+    }
+
+    return std::nullopt;
+  }
+
+  std::optional<PlacementScenario> same_ccx(size_t producer_n, size_t consumer_n) const
+  {
+    for (size_t l3 : topology_.l3_domains())
+    {
+      auto cores = cores_where([&](const PhysicalCore& c) { return c.l3_id == l3; });
+      if (cores.size() < producer_n + consumer_n)
+        continue;
+
+      return PlacementScenario{"same_ccx", first_threads(cores, 0, producer_n),
+                               first_threads(cores, producer_n, consumer_n)};
+    }
+
+    return std::nullopt;
+  }
+
+  std::optional<PlacementScenario> cross_ccx(size_t producer_n, size_t consumer_n) const
+  {
+    for (size_t producer_l3 : topology_.l3_domains())
+    {
+      auto producer_cores = cores_where([&](const PhysicalCore& c) { return c.l3_id == producer_l3; });
+      if (producer_cores.size() < producer_n)
+        continue;
+
+      size_t package_id = producer_cores.front()->package_id;
+      for (size_t consumer_l3 : topology_.l3_domains())
+      {
+        if (consumer_l3 == producer_l3)
+          continue;
+
+        auto consumer_cores = cores_where(
+          [&](const PhysicalCore& c) { return c.l3_id == consumer_l3 && c.package_id == package_id; });
+        if (consumer_cores.size() < consumer_n)
+          continue;
+
+        return PlacementScenario{"cross_ccx", first_threads(producer_cores, 0, producer_n),
+                                 first_threads(consumer_cores, 0, consumer_n)};
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  std::optional<PlacementScenario> cross_socket(size_t producer_n, size_t consumer_n) const
+  {
+    for (size_t producer_package : topology_.packages())
+    {
+      auto producer_cores =
+        cores_where([&](const PhysicalCore& c) { return c.package_id == producer_package; });
+      if (producer_cores.size() < producer_n)
+        continue;
+
+      for (size_t consumer_package : topology_.packages())
+      {
+        if (consumer_package == producer_package)
+          continue;
+
+        auto consumer_cores =
+          cores_where([&](const PhysicalCore& c) { return c.package_id == consumer_package; });
+        if (consumer_cores.size() < consumer_n)
+          continue;
+
+        return PlacementScenario{"cross_socket", first_threads(producer_cores, 0, producer_n),
+                                 first_threads(consumer_cores, 0, consumer_n)};
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  // Every combination of ring buffer memory node, producer node and consumer node, named
+  // numa_p<P>_c<C>_mem<M>. Node combinations without enough physical cores are skipped. Benchmarks
+  // whose contexts ignore the allocation policy refuse these placements, see set_alloc_policy.
+  std::vector<PlacementScenario> numa_matrix(size_t producer_n, size_t consumer_n) const
+  {
+    std::vector<PlacementScenario> result;
+    for (size_t memory_node : topology_.numa_nodes())
+    {
+      for (size_t producer_node : topology_.numa_nodes())
+      {
+        auto producer_cores =
+          cores_where([&](const PhysicalCore& c) { return c.numa_node == producer_node; });
+        for (size_t consumer_node : topology_.numa_nodes())
+        {
+          auto consumer_cores =
+            cores_where([&](const PhysicalCore& c) { return c.numa_node == consumer_node; });
+
+          // producers and consumers on the same node get distinct cores
+          size_t consumer_offset = producer_node == consumer_node ? producer_n : 0;
+          if (producer_cores.size() < producer_n || consumer_cores.size() < consumer_offset + consumer_n)
+            continue;
+
+          PlacementScenario s{"numa_p" + std::to_string(producer_node) + "_c" +
+                                std::to_string(consumer_node) + "_mem" + std::to_string(memory_node),
+                              first_threads(producer_cores, 0, producer_n),
+                              first_threads(consumer_cores, consumer_offset, consumer_n)};
+          s.memory_node = static_cast<int>(memory_node);
+          result.push_back(std::move(s));
+        }
+      }
+    }
+
+    return result;
+  }
+
+  std::vector<PlacementScenario> plan(size_t producer_n, size_t consumer_n) const
+  {
+    std::vector<PlacementScenario> result;
+    for (auto scenario : {smt_sibling(producer_n, consumer_n), same_ccx(producer_n, consumer_n),
+                          cross_ccx(producer_n, consumer_n), cross_socket(producer_n, consumer_n)})
+    {
+      if (scenario)
+        result.push_back(std::move(*scenario));
+    }
+
+    return result;
+  }
+};
+
+// names of the plan() placements which keep every thread within one part of
+// CpuTopology::partition(by_package), the others can not be planned within a part
+inline std::vector<std::string> partition_local_placements(bool by_package)
+{
+  if (by_package)
+    return {"smt_sibling", "same_ccx", "cross_ccx"};
+  return {"smt_sibling", "same_ccx"};
+}
+
+// Picks placements by name out of the planner for the given (part of the) machine: "all" or a
+// comma separated list, e.g. "smt_sibling,cross_ccx". "numa_matrix" adds the whole NUMA matrix,
+// it is not part of "all".
+inline std::vector<PlacementScenario> select_placements(const CpuTopology& topology,
+                                                        const std::string& requested,
+                                                        size_t producer_n, size_t consumer_n)
+{
+  std::vector<PlacementScenario> result;
+  PlacementPlanner planner(topology);
+  for (PlacementScenario& s : planner.plan(producer_n, consumer_n))
+  {
+    if (requested == "all" || ("," + requested + ",").find("," + s.name + ",") != std::string::npos)
+      result.push_back(std::move(s));
+  }
+
+  if (("," + requested + ",").find(",numa_matrix,") != std::string::npos)
+  {
+    for (PlacementScenario& s : planner.numa_matrix(producer_n, consumer_n))
+      result.push_back(std::move(s));
+  }
+
+  if (result.empty())
+  {
+    std::cerr << "WARNING: none of the requested placements [" << requested << "] fit " << producer_n
+              << " producers and " << consumer_n << " consumers on this machine\n";
+  }
+
+  return result;
+}
+
+// Same as above for the whole machine. Empty request means a single scenario made of the
+// explicit core lists, or an unpinned one if there are none.
+inline std::vector<PlacementScenario> select_placements(const std::string& requested,
+                                                        size_t producer_n, size_t consumer_n,
+                                                        const std::vector<size_t>& producer_cores = {},
+                                                        const std::vector<size_t>& consumer_cores = {})
+{
+  if (requested.empty())
+  {
+    PlacementScenario s{"", producer_cores, consumer_cores};
+    s.name = producer_cores.empty() && consumer_cores.empty() ? "unpinned" : "custom";
+    return {s};
+  }
+
+  return select_placements(CpuTopology::load(), requested, producer_n, consumer_n);
+}
+
+// same as above, but takes "--placements" and the core lists from the command line
+inline std::vector<PlacementScenario> placement_scenarios_arg(
+  int argc, char** argv, size_t producer_n, size_t consumer_n,
+  const std::string& producer_cores_flag = "--producer-cores",
+  const std::string& consumer_cores_flag = "--consumer-cores")
+{
+  std::string requested;
+  for (int i = 1; i + 1 < argc; ++i)
+  {
+    if (std::string("--placements") == argv[i])
+      requested = argv[i + 1];
+  }
+
+  return select_placements(requested, producer_n, consumer_n,
+                           core_list_arg(argc, argv, producer_cores_flag),
+                           core_list_arg(argc, argv, consumer_cores_flag));
+}
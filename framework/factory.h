@@ -17,7 +17,9 @@
 #pragma once
 
 #include "benchmark_base.h"
+#include "cpu_topology.h"
 #include <cstdint>
+#include <type_traits>
 
 template <class ConcreteBenchmark, class SingleRunResult, class... T>
 static std::function<std::unique_ptr<BenchmarkBase<SingleRunResult>>()> benchmark_creator(
@@ -26,6 +28,15 @@ static std::function<std::unique_ptr<BenchmarkBase<SingleRunResult>>()> benchmar
   return [=]() { return std::make_unique<ConcreteBenchmark>(params...); };
 }
 
+// the placement scenario's cores and name are appended to the benchmark constructor params
+template <class ConcreteBenchmark, class SingleRunResult, class... T>
+static std::function<std::unique_ptr<BenchmarkBase<SingleRunResult>>(const PlacementScenario&)> placed_benchmark_creator(
+  T... params) requires(std::is_same_v<SingleRunResult, typename ConcreteBenchmark::single_run_result>)
+{
+  return [=](const PlacementScenario& s)
+  { return std::make_unique<ConcreteBenchmark>(params..., s.producer_cores, s.consumer_cores, s.name); };
+}
+
 template <class T>
 struct ProduceIncremental
 {
@@ -50,3 +61,34 @@ struct ConsumeAndStore
   volatile T last_val{};
   void operator()(const T& v) { last_val = v; }
 };
+
+// Creators which can also write a message straight into a queue slot, next to T operator()().
+// Adapters of queues with an emplace-with-callback API hand them the slot, which saves the copy
+// of the message through the producer's stack.
+template <class Creator, class T>
+concept InPlaceCreator = requires(Creator& c, T& slot) { c(slot); };
+
+// the message type a creator's T operator()() makes
+template <class Creator>
+using created_message_t = std::remove_cvref_t<std::invoke_result_t<Creator&>>;
+
+template <class Creator>
+struct InPlaceArgs
+{
+  Creator& creator;
+};
+
+// For queues which only placement-new messages from emplace(args...) arguments: the queue
+// constructs InPlaceMessage<T> from InPlaceArgs right in the slot and the constructor runs the
+// creator on it, while consumers keep seeing a T.
+template <class T>
+struct InPlaceMessage : T
+{
+  InPlaceMessage() = default;
+
+  template <class Creator>
+  explicit InPlaceMessage(InPlaceArgs<Creator> args)
+  {
+    args.creator(static_cast<T&>(*this));
+  }
+};
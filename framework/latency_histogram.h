@@ -0,0 +1,172 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tsc_clock.h"
+#include "warmup.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+// HDR-style log-linear histogram: values below 2 * SUB_BUCKET_N are stored exactly, above that
+// every power of two is split into SUB_BUCKET_N linear sub-buckets, which bounds the relative
+// error by 1 / SUB_BUCKET_N (< 1%) across the whole uint64_t range. All buckets are allocated
+// upfront so that record() never allocates on the hot path.
+class LatencyHistogram
+{
+public:
+  static constexpr size_t SUB_BUCKET_BITS = 7;
+  static constexpr size_t SUB_BUCKET_N = size_t{1} << SUB_BUCKET_BITS;
+  static constexpr size_t BUCKET_N = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_N;
+
+private:
+  std::vector<uint64_t> counts_;
+  uint64_t total_count_{0};
+  uint64_t total_sum_{0};
+  uint64_t min_{std::numeric_limits<uint64_t>::max()};
+  uint64_t max_{0};
+  WarmupGate* warmup_{nullptr}; // values are dropped while it is open
+
+  static size_t bucket_idx(uint64_t v)
+  {
+    if (v < 2 * SUB_BUCKET_N)
+      return v;
+
+    size_t shift = (63 - __builtin_clzll(v)) - SUB_BUCKET_BITS;
+    return shift * SUB_BUCKET_N + (v >> shift);
+  }
+
+  // the highest value which falls into the same bucket
+  static uint64_t bucket_highest_value(size_t idx)
+  {
+    if (idx < 2 * SUB_BUCKET_N)
+      return idx;
+
+    size_t shift = idx / SUB_BUCKET_N - 1;
+    uint64_t sub_bucket = idx - shift * SUB_BUCKET_N;
+    return (sub_bucket << shift) + ((uint64_t{1} << shift) - 1);
+  }
+
+public:
+  LatencyHistogram() : counts_(BUCKET_N, 0) {}
+
+  // the gate must outlive recording, it is dropped as soon as the warmup is over
+  void set_warmup(WarmupGate* gate) { warmup_ = gate; }
+
+  void record(uint64_t v)
+  {
+    if (warmup_ != nullptr) [[unlikely]]
+    {
+      if (warmup_->absorb(v))
+        return;
+      warmup_ = nullptr;
+    }
+
+    ++counts_[bucket_idx(v)];
+    ++total_count_;
+    total_sum_ += v;
+    min_ = std::min(min_, v);
+    max_ = std::max(max_, v);
+  }
+
+  void merge(const LatencyHistogram& other)
+  {
+    for (size_t i = 0; i < BUCKET_N; ++i)
+      counts_[i] += other.counts_[i];
+
+    total_count_ += other.total_count_;
+    total_sum_ += other.total_sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  void reset()
+  {
+    std::fill(begin(counts_), end(counts_), 0);
+    total_count_ = 0;
+    total_sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+  }
+
+  uint64_t count() const { return total_count_; }
+  uint64_t min() const { return total_count_ ? min_ : 0; }
+  uint64_t max() const { return max_; }
+  double mean() const { return total_count_ ? total_sum_ / static_cast<double>(total_count_) : 0; }
+
+  // percentile is in [0, 100] range, e.g. 99.99
+  uint64_t value_at_percentile(double percentile) const
+  {
+    if (total_count_ == 0)
+      return 0;
+
+    uint64_t target = std::max<uint64_t>(1, std::ceil(percentile / 100.0 * total_count_));
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < BUCKET_N; ++i)
+    {
+      cumulative += counts_[i];
+      if (cumulative >= target)
+        return std::min(bucket_highest_value(i), max_);
+    }
+
+    return max_;
+  }
+};
+
+// nanosecond percentiles of a histogram recorded in TSC cycles, as reported in the CSV stats
+struct LatencyPercentiles
+{
+  double avg{0};
+  size_t min{0};
+  size_t d50{0};
+  size_t d90{0};
+  size_t d99{0};
+  size_t d999{0};
+  size_t d9999{0};
+  size_t max{0};
+
+  static LatencyPercentiles from_cycles(const LatencyHistogram& h)
+  {
+    const TscClock& clock = TscClock::instance();
+    LatencyPercentiles p;
+    p.avg = clock.cycles_to_ns(h.mean());
+    p.min = clock.cycles_to_ns(h.min());
+    p.d50 = clock.cycles_to_ns(h.value_at_percentile(50));
+    p.d90 = clock.cycles_to_ns(h.value_at_percentile(90));
+    p.d99 = clock.cycles_to_ns(h.value_at_percentile(99));
+    p.d999 = clock.cycles_to_ns(h.value_at_percentile(99.9));
+    p.d9999 = clock.cycles_to_ns(h.value_at_percentile(99.99));
+    p.max = clock.cycles_to_ns(h.max());
+    return p;
+  }
+
+  static const char* csv_header()
+  {
+    return "avg_msg_ns,min_msg_ns,50_msg_ns,90_msg_ns,99_msg_ns,99.9_msg_ns,99.99_msg_ns,max_msg_ns";
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const LatencyPercentiles& p)
+  {
+    o << std::fixed << std::setprecision(5) << p.avg << "," << p.min << "," << p.d50 << "," << p.d90
+      << "," << p.d99 << "," << p.d999 << "," << p.d9999 << "," << p.max;
+    return o;
+  }
+};
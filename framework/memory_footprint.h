@@ -0,0 +1,143 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Bytes requested through the global operator new by the current thread. The counting operator
+// new lives in a single TU of an executable (see benchmark/qbench/alloc_counter.cpp), executables
+// without it report the allocations as n/a. Vendor contexts get constructed on the thread which
+// creates the benchmark, so the per-thread counter sees exactly what a context allocates,
+// whichever allocator the queue is templated on as long as it ends up in operator new.
+struct AllocationCounter
+{
+  static inline thread_local uint64_t bytes{0};
+  static inline thread_local uint64_t alloc_num{0};
+  static inline std::atomic_bool installed{false};
+
+  static void on_alloc(size_t sz)
+  {
+    bytes += sz;
+    ++alloc_num;
+  }
+};
+
+// process wide memory state at a point in time
+struct MemorySample
+{
+  uint64_t alloc_bytes{0}; // current thread only
+  uint64_t alloc_num{0};
+  uint64_t rss_bytes{0};
+  uint64_t minor_fault_num{0};
+  uint64_t major_fault_num{0};
+
+  static MemorySample now()
+  {
+    MemorySample s;
+    s.alloc_bytes = AllocationCounter::bytes;
+    s.alloc_num = AllocationCounter::alloc_num;
+
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+      s.minor_fault_num = usage.ru_minflt;
+      s.major_fault_num = usage.ru_majflt;
+    }
+
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size_pages{0}, resident_pages{0};
+    if (statm >> size_pages >> resident_pages)
+      s.rss_bytes = resident_pages * sysconf(_SC_PAGESIZE);
+
+    return s;
+  }
+};
+
+struct MemoryFootprint
+{
+  // construction of the vendor contexts of a single benchmark instance
+  uint64_t context_bytes{0};
+  uint64_t context_alloc_num{0};
+  size_t slot_num{0}; // ring buffer slots over all contexts
+  int64_t context_rss_bytes{0};
+  uint64_t context_minor_fault_num{0};
+  uint64_t context_major_fault_num{0};
+
+  // summed over runs, reported per run
+  size_t run_num{0};
+  int64_t run_rss_bytes{0};
+  uint64_t run_minor_fault_num{0};
+  uint64_t run_major_fault_num{0};
+
+  double bytes_per_slot() const { return slot_num ? context_bytes / static_cast<double>(slot_num) : 0; }
+
+  void add_run(const MemorySample& before, const MemorySample& after)
+  {
+    ++run_num;
+    run_rss_bytes += static_cast<int64_t>(after.rss_bytes) - static_cast<int64_t>(before.rss_bytes);
+    run_minor_fault_num += after.minor_fault_num - before.minor_fault_num;
+    run_major_fault_num += after.major_fault_num - before.major_fault_num;
+  }
+
+  static const char* csv_header()
+  {
+    return "context_bytes,bytes_per_slot,context_allocs,context_rss_kb,context_minflt,"
+           "context_majflt,run_rss_kb,run_minflt,run_majflt";
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const MemoryFootprint& m)
+  {
+    double runs = m.run_num ? m.run_num : 1;
+    o << std::fixed << std::setprecision(2);
+    if (AllocationCounter::installed)
+      o << m.context_bytes << "," << m.bytes_per_slot() << "," << m.context_alloc_num;
+    else
+      o << "n/a,n/a,n/a";
+    o << "," << m.context_rss_bytes / 1024.0 << "," << m.context_minor_fault_num << ","
+      << m.context_major_fault_num << "," << m.run_rss_bytes / 1024.0 / runs << ","
+      << m.run_minor_fault_num / runs << "," << m.run_major_fault_num / runs;
+    return o;
+  }
+};
+
+// Declared right before the context members of a benchmark, so that it samples the memory state
+// before the contexts get constructed and finish() called in the constructor body sees their cost.
+class MemoryProbe
+{
+  MemorySample start_{MemorySample::now()};
+
+public:
+  MemoryFootprint finish(size_t slot_num) const
+  {
+    MemorySample end = MemorySample::now();
+    MemoryFootprint f;
+    f.context_bytes = end.alloc_bytes - start_.alloc_bytes;
+    f.context_alloc_num = end.alloc_num - start_.alloc_num;
+    f.slot_num = slot_num;
+    f.context_rss_bytes = static_cast<int64_t>(end.rss_bytes) - static_cast<int64_t>(start_.rss_bytes);
+    f.context_minor_fault_num = end.minor_fault_num - start_.minor_fault_num;
+    f.context_major_fault_num = end.major_fault_num - start_.major_fault_num;
+    return f;
+  }
+};
@@ -0,0 +1,199 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "cpu_affinity.h"
+#include "results_store.h"
+#include "statistics.h"
+#include "tsc_clock.h"
+#include <algorithm>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A benchmark which ran in parallel with others, re-run alone to see whether its neighbours
+// skewed it: slowdown_pct > 0 means the parallel runs were worse than the serial ones.
+struct InterferenceCheck
+{
+  std::string key;
+  std::string metric;
+  double parallel_median{0};
+  double serial_median{0};
+  double slowdown_pct{0};
+  double p_worse{1}; // one-sided Mann-Whitney U p-value of "parallel runs are worse"
+
+  bool interfered(double alpha, double threshold_pct) const
+  {
+    return p_worse < alpha && slowdown_pct > threshold_pct;
+  }
+
+  static std::string csv_header()
+  {
+    return "key,metric,parallel_median,serial_median,slowdown_pct,p_worse\n";
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const InterferenceCheck& c)
+  {
+    o << c.key << "," << c.metric << "," << std::fixed << std::setprecision(2) << c.parallel_median
+      << "," << c.serial_median << "," << c.slowdown_pct << "," << std::setprecision(5) << c.p_worse
+      << "\n";
+    return o;
+  }
+};
+
+// Runs independent benchmarks concurrently: every core group (see CpuTopology::partition) gets a
+// suite of its own, with its own worker pool and randomized interleaving, running on a thread of
+// its own, restricted to the group's cores. Creators of a group must only place threads on those
+// cores, otherwise groups interfere with each other. Process wide numbers, e.g. RSS and page
+// faults of a run, include whatever the other groups did meanwhile.
+template <class Suite>
+class ParallelSuite
+{
+public:
+  using BenchmarkCreator = typename Suite::BenchmarkCreator;
+  using BenchmarkStats = typename decltype(std::declval<Suite&>().go(0))::value_type;
+
+  // group_cpus are the logical cpus of every group, in the same order as group_creators
+  ParallelSuite(size_t iteration_num, std::vector<std::vector<BenchmarkCreator>> group_creators,
+                std::vector<std::vector<size_t>> group_cpus)
+    : group_creators_(std::move(group_creators)),
+      group_cpus_(std::move(group_cpus)),
+      iteration_num_(iteration_num)
+  {
+    if (group_cpus_.size() != group_creators_.size())
+      throw std::runtime_error("every parallel group needs its cpus");
+  }
+
+  void set_adaptive_stopping(const AdaptiveStopping& policy) { stopping_ = policy; }
+
+  // stats of every group, in group order
+  std::vector<BenchmarkStats> go(size_t N)
+  {
+    TscClock::instance(); // calibrate before the groups start loading the machine
+
+    std::vector<std::vector<BenchmarkStats>> group_stats(group_creators_.size());
+    std::vector<std::exception_ptr> errors(group_creators_.size());
+    suites_.clear();
+    for (const std::vector<BenchmarkCreator>& creators : group_creators_)
+    {
+      suites_.push_back(std::make_unique<Suite>(iteration_num_, creators));
+      suites_.back()->set_adaptive_stopping(stopping_);
+    }
+
+    {
+      std::vector<std::jthread> groups;
+      for (size_t group = 0; group < suites_.size(); ++group)
+      {
+        groups.emplace_back(
+          [&, group]()
+          {
+            try
+            {
+              // the suite's worker pool is started from here, so its threads inherit the group
+              restrict_current_thread(group_cpus_[group]);
+              group_stats[group] = suites_[group]->go(N);
+            }
+            catch (...)
+            {
+              errors[group] = std::current_exception();
+            }
+          });
+      }
+    }
+
+    for (const std::exception_ptr& error : errors)
+    {
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+    std::vector<BenchmarkStats> result;
+    for (std::vector<BenchmarkStats>& stats : group_stats)
+      result.insert(end(result), begin(stats), end(stats));
+    return result;
+  }
+
+  std::vector<ResultRecord> records() const
+  {
+    std::vector<ResultRecord> result;
+    for (const auto& suite : suites_)
+    {
+      std::vector<ResultRecord> group_records = suite->records();
+      result.insert(end(result), begin(group_records), end(group_records));
+    }
+    return result;
+  }
+
+  // Re-runs sample_num randomly picked benchmarks of the last go() one by one on an otherwise
+  // idle machine, with the same cores and iterations, and compares them to their parallel runs.
+  std::vector<InterferenceCheck> check_interference(size_t sample_num, size_t N)
+  {
+    std::vector<std::pair<size_t /*group*/, size_t /*creator*/>> candidates;
+    for (size_t group = 0; group < group_creators_.size(); ++group)
+    {
+      for (size_t creator = 0; creator < group_creators_[group].size(); ++creator)
+        candidates.emplace_back(group, creator);
+    }
+
+    std::shuffle(begin(candidates), end(candidates), std::mt19937(std::random_device{}()));
+    candidates.resize(std::min(sample_num, candidates.size()));
+
+    std::vector<ResultRecord> parallel = records();
+    std::vector<InterferenceCheck> result;
+    for (auto [group, creator] : candidates)
+    {
+      Suite serial_suite(iteration_num_,
+                         std::vector<BenchmarkCreator>{group_creators_[group][creator]});
+      serial_suite.set_adaptive_stopping(stopping_);
+      serial_suite.go(N);
+      for (const ResultRecord& serial : serial_suite.records())
+      {
+        auto it = std::find_if(begin(parallel), end(parallel),
+                               [&](const ResultRecord& r) { return r.key == serial.key; });
+        if (it == end(parallel))
+          continue;
+
+        InterferenceCheck c;
+        c.key = serial.key;
+        c.metric = serial.metric;
+        c.parallel_median = median(it->samples);
+        c.serial_median = median(serial.samples);
+        double change_pct = c.serial_median ? (c.parallel_median / c.serial_median - 1) * 100 : 0;
+        c.slowdown_pct = serial.higher_is_better ? -change_pct : change_pct;
+
+        MannWhitneyResult mw = mann_whitney_u(it->samples, serial.samples);
+        c.p_worse = serial.higher_is_better ? mw.p_less : mw.p_greater;
+        result.push_back(c);
+      }
+    }
+
+    return result;
+  }
+
+private:
+  std::vector<std::vector<BenchmarkCreator>> group_creators_;
+  std::vector<std::vector<size_t>> group_cpus_;
+  size_t iteration_num_;
+  AdaptiveStopping stopping_;
+  std::vector<std::unique_ptr<Suite>> suites_;
+};
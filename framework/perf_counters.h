@@ -0,0 +1,225 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <linux/perf_event.h>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum class PerfEvent : size_t
+{
+  CYCLES,
+  INSTRUCTIONS,
+  L1D_MISSES,
+  LLC_MISSES,
+  BRANCH_MISSES,
+  HITM, // loads hitting a modified line in another core's cache, i.e. true cache-line transfers
+  COUNT
+};
+
+inline constexpr size_t PERF_EVENT_N = static_cast<size_t>(PerfEvent::COUNT);
+
+// counter totals, a counter is not available if it could not be opened on any of the threads
+// (unsupported event, perf_event_paranoid, running in a VM, ...)
+struct PerfCounterValues
+{
+  std::array<uint64_t, PERF_EVENT_N> values{};
+  std::array<bool, PERF_EVENT_N> available{};
+
+  void merge(const PerfCounterValues& other)
+  {
+    for (size_t i = 0; i < PERF_EVENT_N; ++i)
+    {
+      values[i] += other.values[i];
+      available[i] = available[i] && other.available[i];
+    }
+  }
+
+  static PerfCounterValues all_available()
+  {
+    PerfCounterValues v;
+    v.available.fill(true);
+    return v;
+  }
+};
+
+// Counts hardware events of the calling thread only, user space only. Counters are opened
+// disabled, so that opening them can happen outside of the measured window, and are enabled by
+// start(). The HITM event is model specific, so it is only opened if QBENCH_PERF_HITM_RAW holds
+// its raw config, e.g. 0x04d2 for MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM on Skylake server.
+class ThreadPerfCounters
+{
+  std::array<int, PERF_EVENT_N> fds_;
+
+  static std::optional<perf_event_attr> attr_for(PerfEvent e)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (e)
+    {
+    case PerfEvent::CYCLES:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case PerfEvent::INSTRUCTIONS:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case PerfEvent::L1D_MISSES:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      break;
+    case PerfEvent::LLC_MISSES:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      break;
+    case PerfEvent::BRANCH_MISSES:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+    case PerfEvent::HITM:
+    {
+      const char* raw = std::getenv("QBENCH_PERF_HITM_RAW");
+      if (raw == nullptr || *raw == '\0')
+        return std::nullopt;
+      attr.type = PERF_TYPE_RAW;
+      attr.config = std::stoull(raw, nullptr, 0);
+      break;
+    }
+    default:
+      return std::nullopt;
+    }
+
+    return attr;
+  }
+
+public:
+  ThreadPerfCounters()
+  {
+    for (size_t i = 0; i < PERF_EVENT_N; ++i)
+    {
+      fds_[i] = -1;
+      if (auto attr = attr_for(static_cast<PerfEvent>(i)))
+        fds_[i] = syscall(SYS_perf_event_open, &*attr, 0 /*this thread*/, -1 /*any cpu*/, -1, 0);
+    }
+  }
+
+  ~ThreadPerfCounters()
+  {
+    for (int fd : fds_)
+    {
+      if (fd >= 0)
+        close(fd);
+    }
+  }
+
+  ThreadPerfCounters(const ThreadPerfCounters&) = delete;
+  ThreadPerfCounters& operator=(const ThreadPerfCounters&) = delete;
+
+  void start()
+  {
+    for (int fd : fds_)
+    {
+      if (fd >= 0)
+      {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  void stop()
+  {
+    for (int fd : fds_)
+    {
+      if (fd >= 0)
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+
+  PerfCounterValues read() const
+  {
+    PerfCounterValues result;
+    for (size_t i = 0; i < PERF_EVENT_N; ++i)
+    {
+      uint64_t data[3]; // value, time enabled, time running
+      if (fds_[i] < 0 || ::read(fds_[i], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+        continue;
+
+      // the kernel multiplexes counters if there are more events than hardware counters,
+      // extrapolate to the whole enabled time in that case
+      result.values[i] = data[2] < data[1]
+        ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+        : data[0];
+      result.available[i] = true;
+    }
+
+    return result;
+  }
+};
+
+// counters divided by the number of messages, or round trips, as reported in the CSV stats
+struct PerfCountersPerMessage
+{
+  // column names, in PerfEvent order
+  static constexpr std::array<const char*, PERF_EVENT_N> NAMES = {
+    "cycles_msg", "instructions_msg", "l1d_miss_msg", "llc_miss_msg", "branch_miss_msg", "hitm_msg"};
+
+  PerfCounterValues totals;
+  double msg_num{0};
+
+  static std::string csv_header()
+  {
+    std::string header;
+    for (size_t i = 0; i < PERF_EVENT_N; ++i)
+      header += (i ? "," : "") + std::string(NAMES[i]);
+    return header;
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const PerfCountersPerMessage& p)
+  {
+    for (size_t i = 0; i < PERF_EVENT_N; ++i)
+    {
+      if (i > 0)
+        o << ",";
+
+      if (p.totals.available[i] && p.msg_num > 0)
+        o << std::fixed << std::setprecision(3) << p.totals.values[i] / p.msg_num;
+      else
+        o << "n/a";
+    }
+
+    return o;
+  }
+};
@@ -0,0 +1,462 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Machine-readable results as JSON lines: an "environment" record per qbench invocation followed
+// by one "benchmark" record per benchmark key holding the raw per-iteration samples, so that
+// results of different builds/machines can be compared later by qbench-compare.
+
+// set by the build, see benchmark/CMakeLists.txt
+#ifndef QBENCH_CXX_FLAGS
+#define QBENCH_CXX_FLAGS "unknown"
+#endif
+
+struct RunEnvironment
+{
+  std::string git_rev;
+  std::string compiler;
+  std::string cxx_flags;
+  std::string cpu_model;
+  std::string mode;
+
+  // git_rev comes from the caller, as it changes with every commit only one TU should see it
+  static RunEnvironment current(const std::string& mode, const std::string& git_rev)
+  {
+    RunEnvironment env;
+    env.git_rev = git_rev;
+#if defined(__clang__)
+    env.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    env.compiler = "gcc " __VERSION__;
+#else
+    env.compiler = "unknown";
+#endif
+    env.cxx_flags = QBENCH_CXX_FLAGS;
+    env.cpu_model = read_cpu_model();
+    env.mode = mode;
+    return env;
+  }
+
+  static std::string read_cpu_model(const std::string& cpuinfo = "/proc/cpuinfo")
+  {
+    std::ifstream f(cpuinfo);
+    std::string line;
+    while (std::getline(f, line))
+    {
+      if (line.rfind("model name", 0) == 0)
+      {
+        size_t colon = line.find(':');
+        if (colon != std::string::npos)
+          return line.substr(line.find_first_not_of(" \t", colon + 1));
+      }
+    }
+
+    return "unknown";
+  }
+};
+
+// per-iteration samples of the headline metric of a single benchmark key
+struct ResultRecord
+{
+  std::string key; // BenchmarkBase::key(), plus the offered load for load sweep points
+  std::string name;
+  std::string vendor;
+  std::string msg_type;
+  size_t ring_buffer_sz{0};
+  size_t producer_num{0};
+  size_t consumer_num{0};
+  std::string placement;
+  std::string alloc_policy{"default"};
+  std::string producer_cores;
+  std::string consumer_cores;
+  std::string metric; // e.g. msg_sec, avg_round_trip_ns
+  bool higher_is_better{false};
+  std::vector<double> samples;
+  // per-iteration secondary metrics next to the samples, e.g. perf counters per message by their
+  // CSV column name, only those available in every iteration
+  std::map<std::string, std::vector<double>> counters;
+};
+
+// The subset of JSON the store writes: objects, arrays, strings, numbers and booleans.
+class JsonValue
+{
+public:
+  enum class Type
+  {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+  };
+
+  Type type{Type::Null};
+  bool boolean{false};
+  double number{0};
+  std::string string;
+  std::vector<JsonValue> array;
+  std::map<std::string, JsonValue> object;
+
+  static JsonValue parse(const std::string& text)
+  {
+    size_t pos = 0;
+    JsonValue v = parse_value(text, pos);
+    skip_ws(text, pos);
+    if (pos != text.size())
+      throw std::runtime_error("trailing characters in JSON [" + text + "]");
+    return v;
+  }
+
+  const JsonValue& at(const std::string& name) const
+  {
+    auto it = object.find(name);
+    if (type != Type::Object || it == object.end())
+      throw std::runtime_error("JSON field [" + name + "] is missing");
+    return it->second;
+  }
+
+  bool has(const std::string& name) const { return type == Type::Object && object.count(name) != 0; }
+
+  static void write_string(std::ostream& o, const std::string& s)
+  {
+    o << '"';
+    for (char c : s)
+    {
+      switch (c)
+      {
+      case '"':
+        o << "\\\"";
+        break;
+      case '\\':
+        o << "\\\\";
+        break;
+      case '\n':
+        o << "\\n";
+        break;
+      case '\t':
+        o << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          o << buf;
+        }
+        else
+          o << c;
+      }
+    }
+    o << '"';
+  }
+
+private:
+  static void skip_ws(const std::string& text, size_t& pos)
+  {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+      ++pos;
+  }
+
+  static void expect(const std::string& text, size_t& pos, char c)
+  {
+    skip_ws(text, pos);
+    if (pos >= text.size() || text[pos] != c)
+      throw std::runtime_error(std::string("expected '") + c + "' in JSON at offset " + std::to_string(pos));
+    ++pos;
+  }
+
+  static std::string parse_string(const std::string& text, size_t& pos)
+  {
+    expect(text, pos, '"');
+    std::string result;
+    while (pos < text.size() && text[pos] != '"')
+    {
+      char c = text[pos++];
+      if (c != '\\')
+      {
+        result += c;
+        continue;
+      }
+
+      if (pos >= text.size())
+        break;
+
+      char escaped = text[pos++];
+      switch (escaped)
+      {
+      case 'n':
+        result += '\n';
+        break;
+      case 't':
+        result += '\t';
+        break;
+      case 'r':
+        result += '\r';
+        break;
+      case 'b':
+        result += '\b';
+        break;
+      case 'f':
+        result += '\f';
+        break;
+      case 'u':
+        // only control characters are escaped this way by the writer
+        result += static_cast<char>(std::stoi(text.substr(pos, 4), nullptr, 16));
+        pos += 4;
+        break;
+      default:
+        result += escaped;
+      }
+    }
+
+    expect(text, pos, '"');
+    return result;
+  }
+
+  static JsonValue parse_value(const std::string& text, size_t& pos)
+  {
+    skip_ws(text, pos);
+    if (pos >= text.size())
+      throw std::runtime_error("unexpected end of JSON");
+
+    JsonValue v;
+    char c = text[pos];
+    if (c == '{')
+    {
+      v.type = Type::Object;
+      ++pos;
+      skip_ws(text, pos);
+      if (pos < text.size() && text[pos] == '}')
+      {
+        ++pos;
+        return v;
+      }
+
+      while (true)
+      {
+        std::string name = parse_string(text, pos);
+        expect(text, pos, ':');
+        v.object[name] = parse_value(text, pos);
+        skip_ws(text, pos);
+        if (pos < text.size() && text[pos] == ',')
+        {
+          ++pos;
+          continue;
+        }
+        expect(text, pos, '}');
+        return v;
+      }
+    }
+    else if (c == '[')
+    {
+      v.type = Type::Array;
+      ++pos;
+      skip_ws(text, pos);
+      if (pos < text.size() && text[pos] == ']')
+      {
+        ++pos;
+        return v;
+      }
+
+      while (true)
+      {
+        v.array.push_back(parse_value(text, pos));
+        skip_ws(text, pos);
+        if (pos < text.size() && text[pos] == ',')
+        {
+          ++pos;
+          continue;
+        }
+        expect(text, pos, ']');
+        return v;
+      }
+    }
+    else if (c == '"')
+    {
+      v.type = Type::String;
+      v.string = parse_string(text, pos);
+    }
+    else if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 5, "false") == 0)
+    {
+      v.type = Type::Bool;
+      v.boolean = c == 't';
+      pos += v.boolean ? 4 : 5;
+    }
+    else if (text.compare(pos, 4, "null") == 0)
+    {
+      pos += 4;
+    }
+    else
+    {
+      v.type = Type::Number;
+      size_t consumed = 0;
+      v.number = std::stod(text.substr(pos, 32), &consumed);
+      pos += consumed;
+    }
+
+    return v;
+  }
+};
+
+inline void write_json(std::ostream& o, const RunEnvironment& env)
+{
+  o << "{\"record\":\"environment\",\"git_rev\":";
+  JsonValue::write_string(o, env.git_rev);
+  o << ",\"compiler\":";
+  JsonValue::write_string(o, env.compiler);
+  o << ",\"cxx_flags\":";
+  JsonValue::write_string(o, env.cxx_flags);
+  o << ",\"cpu_model\":";
+  JsonValue::write_string(o, env.cpu_model);
+  o << ",\"mode\":";
+  JsonValue::write_string(o, env.mode);
+  o << "}\n";
+}
+
+inline void write_json(std::ostream& o, const ResultRecord& r)
+{
+  o << "{\"record\":\"benchmark\",\"key\":";
+  JsonValue::write_string(o, r.key);
+  o << ",\"name\":";
+  JsonValue::write_string(o, r.name);
+  o << ",\"vendor\":";
+  JsonValue::write_string(o, r.vendor);
+  o << ",\"msg_type\":";
+  JsonValue::write_string(o, r.msg_type);
+  o << ",\"ring_buffer_sz\":" << r.ring_buffer_sz << ",\"producer_n\":" << r.producer_num
+    << ",\"consumer_n\":" << r.consumer_num << ",\"placement\":";
+  JsonValue::write_string(o, r.placement);
+  o << ",\"alloc_policy\":";
+  JsonValue::write_string(o, r.alloc_policy);
+  o << ",\"producer_cores\":";
+  JsonValue::write_string(o, r.producer_cores);
+  o << ",\"consumer_cores\":";
+  JsonValue::write_string(o, r.consumer_cores);
+  o << ",\"metric\":";
+  JsonValue::write_string(o, r.metric);
+  o << ",\"higher_is_better\":" << (r.higher_is_better ? "true" : "false") << ",\"samples\":[";
+  o << std::setprecision(17) << std::defaultfloat;
+  for (size_t i = 0; i < r.samples.size(); ++i)
+    o << (i ? "," : "") << r.samples[i];
+  o << "],\"counters\":{";
+  for (auto it = r.counters.begin(); it != r.counters.end(); ++it)
+  {
+    o << (it != r.counters.begin() ? "," : "");
+    JsonValue::write_string(o, it->first);
+    o << ":[";
+    for (size_t i = 0; i < it->second.size(); ++i)
+      o << (i ? "," : "") << it->second[i];
+    o << "]";
+  }
+  o << "}}\n";
+}
+
+inline ResultRecord record_from_json(const JsonValue& v)
+{
+  ResultRecord r;
+  r.key = v.at("key").string;
+  r.name = v.at("name").string;
+  r.vendor = v.at("vendor").string;
+  r.msg_type = v.at("msg_type").string;
+  r.ring_buffer_sz = static_cast<size_t>(v.at("ring_buffer_sz").number);
+  r.producer_num = static_cast<size_t>(v.at("producer_n").number);
+  r.consumer_num = static_cast<size_t>(v.at("consumer_n").number);
+  r.placement = v.at("placement").string;
+  if (v.has("alloc_policy")) // absent in stores written before allocation policies
+    r.alloc_policy = v.at("alloc_policy").string;
+  r.producer_cores = v.at("producer_cores").string;
+  r.consumer_cores = v.at("consumer_cores").string;
+  r.metric = v.at("metric").string;
+  r.higher_is_better = v.at("higher_is_better").boolean;
+  for (const JsonValue& sample : v.at("samples").array)
+    r.samples.push_back(sample.number);
+  if (v.has("counters")) // absent in stores written before per-iteration counters
+  {
+    for (const auto& [counter, values] : v.at("counters").object)
+    {
+      std::vector<double>& counter_samples = r.counters[counter]; // kept even if empty
+      for (const JsonValue& value : values.array)
+        counter_samples.push_back(value.number);
+    }
+  }
+  return r;
+}
+
+// Appends to a JSON lines file, an environment record is written once per store.
+class ResultsStore
+{
+public:
+  ResultsStore(const std::string& path, const RunEnvironment& env)
+    : f_(path, std::ios::app), path_(path)
+  {
+    if (!f_)
+      throw std::runtime_error("could not open results file [" + path + "]");
+    write_json(f_, env);
+  }
+
+  void add(const std::vector<ResultRecord>& records)
+  {
+    for (const ResultRecord& r : records)
+      write_json(f_, r);
+    f_.flush();
+    if (!f_)
+      throw std::runtime_error("could not write results file [" + path_ + "]");
+  }
+
+  // the last record wins if the same key was stored more than once, e.g. by appending runs
+  static std::unordered_map<std::string, ResultRecord> load(const std::string& path)
+  {
+    std::ifstream f(path);
+    if (!f)
+      throw std::runtime_error("could not open results file [" + path + "]");
+
+    std::unordered_map<std::string, ResultRecord> result;
+    std::string line;
+    while (std::getline(f, line))
+    {
+      if (line.find_first_not_of(" \t\r") == std::string::npos)
+        continue;
+
+      JsonValue v = JsonValue::parse(line);
+      if (v.has("record") && v.at("record").string == "benchmark")
+      {
+        ResultRecord r = record_from_json(v);
+        result[r.key] = std::move(r);
+      }
+    }
+
+    return result;
+  }
+
+private:
+  std::ofstream f_;
+  std::string path_;
+};
@@ -0,0 +1,88 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tsc_clock.h"
+#include "worker_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <x86intrin.h>
+
+// Releases all threads at the same TSC deadline rather than at the moment each of them happens
+// to observe the last arrival: the last thread to arrive publishes a deadline slightly in the
+// future and everyone spins on the TSC until it passes, so the release skew is bounded by the
+// TSC read cost instead of the cache-line ping-pong of a counter poll.
+class TscStartBarrier
+{
+  alignas(64) std::atomic_size_t arrived_num_{0};
+  alignas(64) std::atomic_uint64_t deadline_tsc_{0};
+  size_t thread_num_;
+  uint64_t lead_cycles_;
+  const std::atomic_bool* run_aborted_;
+
+public:
+  // Lead must be long enough for every spinning thread to read the published deadline. Threads
+  // waiting for the others throw RunAborted once run_aborted is set, e.g. as one of them failed.
+  explicit TscStartBarrier(size_t thread_num, const std::atomic_bool* run_aborted = nullptr,
+                           double lead_ns = 50 * NANO_PER_MICRO)
+    : thread_num_(thread_num), lead_cycles_(TscClock::instance().ns_to_cycles(lead_ns)), run_aborted_(run_aborted)
+  {
+  }
+
+  TscStartBarrier(const TscStartBarrier&) = delete;
+  TscStartBarrier& operator=(const TscStartBarrier&) = delete;
+
+  // returns the TSC at which the calling thread actually got released
+  uint64_t arrive_and_wait()
+  {
+    if (arrived_num_.fetch_add(1, std::memory_order_acq_rel) + 1 == thread_num_)
+      deadline_tsc_.store(TscClock::rdtsc() + lead_cycles_, std::memory_order_release);
+
+    uint64_t deadline;
+    while ((deadline = deadline_tsc_.load(std::memory_order_acquire)) == 0)
+    {
+      if (run_aborted_ && run_aborted_->load(std::memory_order_acquire)) [[unlikely]]
+        throw RunAborted();
+      _mm_pause();
+    }
+
+    uint64_t now = TscClock::rdtsc();
+    while (now < deadline)
+    {
+      _mm_pause();
+      now = TscClock::rdtsc();
+    }
+
+    return now;
+  }
+
+  uint64_t deadline_tsc() const { return deadline_tsc_.load(std::memory_order_acquire); }
+};
+
+// active window of a single benchmark thread, from its release to the return of its last op
+struct ThreadActiveWindow
+{
+  uint64_t start_tsc{0};
+  uint64_t stop_tsc{0};
+  size_t msg_num{0};
+
+  double msg_per_second() const
+  {
+    double seconds = TscClock::instance().cycles_to_ns(stop_tsc - start_tsc) / NANO_PER_SEC;
+    return seconds > 0 ? msg_num / seconds : 0;
+  }
+};
@@ -0,0 +1,254 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Statistics over per-run samples, i.e. one value per benchmark iteration, used by the suites to
+// summarize runs and to decide when a benchmark has been run often enough.
+
+// q is in [0, 1], linear interpolation between the closest ranks, so it is well defined for any
+// number of samples unlike picking samples[size * q]
+inline double quantile_sorted(const std::vector<double>& sorted, double q)
+{
+  if (sorted.empty())
+    throw std::runtime_error("quantile of an empty sample");
+
+  double pos = std::clamp(q, 0.0, 1.0) * (sorted.size() - 1);
+  size_t lo = static_cast<size_t>(pos);
+  size_t hi = std::min(lo + 1, sorted.size() - 1);
+  return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+}
+
+inline double quantile(std::vector<double> samples, double q)
+{
+  std::sort(begin(samples), end(samples));
+  return quantile_sorted(samples, q);
+}
+
+inline double median(std::vector<double> samples) { return quantile(std::move(samples), 0.5); }
+
+inline double mean(const std::vector<double>& samples)
+{
+  return samples.empty() ? 0 : std::accumulate(begin(samples), end(samples), 0.0) / samples.size();
+}
+
+// sample standard deviation
+inline double stddev(const std::vector<double>& samples)
+{
+  if (samples.size() < 2)
+    return 0;
+
+  double m = mean(samples);
+  double sq_sum = 0;
+  for (double v : samples)
+    sq_sum += (v - m) * (v - m);
+  return std::sqrt(sq_sum / (samples.size() - 1));
+}
+
+struct ConfidenceInterval
+{
+  double lower{0};
+  double upper{0};
+
+  // width relative to center, e.g. the sample median the interval is for, in percent. For skewed
+  // runs the interval is not centred on it, so its midpoint would not do.
+  double relative_width_pct(double center) const
+  {
+    return center != 0 ? 100.0 * (upper - lower) / std::abs(center) : 0;
+  }
+};
+
+// Percentile bootstrap of the median: makes no assumption about the run distribution, which is
+// usually skewed and multi-modal for queue benchmarks. Seeded, so the same runs give the same CI.
+inline ConfidenceInterval bootstrap_median_ci(const std::vector<double>& samples,
+                                              double confidence = 0.95,
+                                              size_t resample_num = 1000, uint64_t seed = 42)
+{
+  if (samples.empty())
+    return {};
+
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<size_t> pick(0, samples.size() - 1);
+  std::vector<double> medians(resample_num);
+  std::vector<double> resample(samples.size());
+  for (double& m : medians)
+  {
+    for (double& v : resample)
+      v = samples[pick(rng)];
+    m = median(resample);
+  }
+
+  std::sort(begin(medians), end(medians));
+  double alpha = (1 - confidence) / 2;
+  return ConfidenceInterval{quantile_sorted(medians, alpha), quantile_sorted(medians, 1 - alpha)};
+}
+
+inline double median_absolute_deviation(const std::vector<double>& samples)
+{
+  if (samples.empty())
+    return 0;
+
+  double m = median(samples);
+  std::vector<double> deviations;
+  deviations.reserve(samples.size());
+  for (double v : samples)
+    deviations.push_back(std::abs(v - m));
+  return median(std::move(deviations));
+}
+
+// Iglewicz and Hoaglin modified z-score, |0.6745 * (x - median) / MAD| > threshold flags an
+// outlier. Unlike mean/stddev it is not dragged by the outliers themselves.
+inline std::vector<bool> mad_outliers(const std::vector<double>& samples, double threshold = 3.5)
+{
+  std::vector<bool> result(samples.size(), false);
+  double mad = median_absolute_deviation(samples);
+  if (mad == 0)
+    return result;
+
+  double m = median(samples);
+  for (size_t i = 0; i < samples.size(); ++i)
+    result[i] = std::abs(0.6745 * (samples[i] - m) / mad) > threshold;
+  return result;
+}
+
+struct MannWhitneyResult
+{
+  double u{0};         // U statistic of the first sample
+  double z{0};         // normal approximation, positive when the first sample tends to be larger
+  double p_greater{1}; // one-sided p-value of "first sample is stochastically greater"
+  double p_less{1};
+};
+
+// Mann-Whitney U test with the normal approximation, corrected for ties and continuity. Rank
+// based, so it holds for the skewed run distributions where a t-test would not; the approximation
+// gets rough below ~8 samples per side.
+inline MannWhitneyResult mann_whitney_u(const std::vector<double>& a, const std::vector<double>& b)
+{
+  MannWhitneyResult result;
+  if (a.empty() || b.empty())
+    return result;
+
+  std::vector<std::pair<double, bool /*from a*/>> all;
+  all.reserve(a.size() + b.size());
+  for (double v : a)
+    all.emplace_back(v, true);
+  for (double v : b)
+    all.emplace_back(v, false);
+  std::sort(begin(all), end(all), [](const auto& l, const auto& r) { return l.first < r.first; });
+
+  // tied values share the average of their ranks
+  double rank_sum_a = 0, tie_term = 0;
+  for (size_t i = 0; i < all.size();)
+  {
+    size_t j = i;
+    while (j < all.size() && all[j].first == all[i].first)
+      ++j;
+
+    double rank = (i + 1 + j) / 2.0;
+    for (size_t k = i; k < j; ++k)
+      rank_sum_a += all[k].second ? rank : 0;
+
+    double t = j - i;
+    tie_term += t * t * t - t;
+    i = j;
+  }
+
+  double n1 = a.size(), n2 = b.size(), n = n1 + n2;
+  result.u = rank_sum_a - n1 * (n1 + 1) / 2;
+
+  double mean_u = n1 * n2 / 2;
+  double var_u = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)));
+  if (var_u <= 0)
+    return result; // every value is the same
+
+  double sd_u = std::sqrt(var_u);
+  result.z = (result.u - mean_u) / sd_u;
+  result.p_greater = 0.5 * std::erfc((result.u - mean_u - 0.5) / sd_u / std::sqrt(2.0));
+  result.p_less = 0.5 * std::erfc(-(result.u - mean_u + 0.5) / sd_u / std::sqrt(2.0));
+  return result;
+}
+
+// distribution of a per-run metric as reported in the CSV stats
+struct RunDistribution
+{
+  double mean{0};
+  double stddev{0};
+  double median{0};
+  ConfidenceInterval median_ci;
+  size_t outlier_num{0};
+
+  static RunDistribution of(const std::vector<double>& samples)
+  {
+    RunDistribution d;
+    if (samples.empty())
+      return d;
+
+    d.mean = ::mean(samples);
+    d.stddev = ::stddev(samples);
+    d.median = ::median(samples);
+    d.median_ci = bootstrap_median_ci(samples);
+    for (bool outlier : mad_outliers(samples))
+      d.outlier_num += outlier;
+    return d;
+  }
+
+  // metric is the column prefix, e.g. msg_sec gives msg_sec_mean,msg_sec_stddev,...
+  static std::string csv_header(const std::string& metric)
+  {
+    return metric + "_mean," + metric + "_stddev," + metric + "_median_ci_low," + metric +
+      "_median_ci_high,outlier_runs";
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const RunDistribution& d)
+  {
+    o << std::fixed << std::setprecision(5) << d.mean << "," << d.stddev << "," << d.median_ci.lower
+      << "," << d.median_ci.upper << "," << d.outlier_num;
+    return o;
+  }
+};
+
+// Keeps a benchmark iterating until the bootstrap CI of its median is narrower than
+// max_median_ci_pct of the median, but runs it at least min_iteration_num times. Suites treat
+// their iteration_num as the upper bound once a policy is set.
+struct AdaptiveStopping
+{
+  double max_median_ci_pct{0}; // 0 disables adaptive stopping
+  size_t min_iteration_num{10};
+  double confidence{0.95};
+
+  bool enabled() const { return max_median_ci_pct > 0; }
+
+  bool converged(const std::vector<double>& samples) const
+  {
+    if (!enabled() || samples.size() < std::max<size_t>(min_iteration_num, 2))
+      return false;
+
+    return bootstrap_median_ci(samples, confidence).relative_width_pct(median(samples)) <=
+      max_median_ci_pct;
+  }
+};
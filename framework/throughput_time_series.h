@@ -0,0 +1,130 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "statistics.h"
+#include "tsc_clock.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// TSC stamp taken by a consumer every stamp_every messages into a buffer allocated before the
+// run, so the hot loop only pays for a mask test and, once per window, an rdtsc and a store.
+class ProgressStamps
+{
+  std::vector<uint64_t> stamps_;
+  size_t mask_{std::numeric_limits<size_t>::max()};
+  size_t stamp_every_{0};
+  size_t n_{0};
+
+public:
+  // stamp_every must be a power of 2, 0 disables stamping
+  void reset(size_t msg_num, size_t stamp_every)
+  {
+    if ((stamp_every & (stamp_every - 1)) != 0)
+      throw std::runtime_error("progress stamp interval must be a power of 2");
+
+    stamp_every_ = stamp_every;
+    mask_ = stamp_every ? stamp_every - 1 : std::numeric_limits<size_t>::max();
+    stamps_.assign(stamp_every ? msg_num / stamp_every : 0, 0);
+    n_ = 0;
+  }
+
+  // consumed_num is the number of messages consumed so far including the current one, it must
+  // not go beyond msg_num given to reset()
+  void on_consumed(size_t consumed_num)
+  {
+    if ((consumed_num & mask_) == 0) [[unlikely]]
+      stamps_[n_++] = TscClock::rdtsc();
+  }
+
+  size_t stamp_every() const { return stamp_every_; }
+  std::vector<uint64_t> stamps() const { return {stamps_.begin(), stamps_.begin() + n_}; }
+
+  // for adapters constructed without stamps, never written to as it is disabled
+  static ProgressStamps& none()
+  {
+    static ProgressStamps stamps;
+    return stamps;
+  }
+};
+
+// Number of leading windows to discard: warmup ends at the first window from which
+// stable_window_num windows in a row reach (1 - tolerance) of the reference rate. The reference
+// is the median of the second half of the run, when the queue is expected to be warm.
+inline size_t detect_warmup_windows(const std::vector<double>& window_rates, double tolerance = 0.1,
+                                    size_t stable_window_num = 4)
+{
+  if (window_rates.size() < 2 * stable_window_num)
+    return 0; // too short to tell
+
+  double reference =
+    median(std::vector<double>(window_rates.begin() + window_rates.size() / 2, window_rates.end()));
+  double floor = (1 - tolerance) * reference;
+
+  size_t stable_num = 0;
+  for (size_t w = 0; w < window_rates.size(); ++w)
+  {
+    stable_num = window_rates[w] >= floor ? stable_num + 1 : 0;
+    if (stable_num == stable_window_num)
+      return w + 1 - stable_window_num;
+  }
+
+  return window_rates.size() / 2;
+}
+
+// msg/sec of a single consumer over consecutive windows of msg_per_window messages
+struct ThroughputTimeSeries
+{
+  size_t msg_per_window{0};
+  std::vector<double> window_msg_per_second;
+  size_t warmup_window_num{0};
+  double steady_msg_per_second{0}; // median of the windows after warmup
+  double worst_window_msg_per_second{0};
+  double max_window_ns{0}; // the longest stall shows up as the slowest window
+
+  size_t warmup_msg_num() const { return warmup_window_num * msg_per_window; }
+
+  static ThroughputTimeSeries from_stamps(uint64_t start_tsc, const std::vector<uint64_t>& stamps,
+                                          size_t msg_per_window)
+  {
+    ThroughputTimeSeries s;
+    s.msg_per_window = msg_per_window;
+    if (stamps.empty())
+      return s;
+
+    const TscClock& clock = TscClock::instance();
+    uint64_t prev_tsc = start_tsc;
+    for (uint64_t tsc : stamps)
+    {
+      double ns = clock.cycles_to_ns(tsc - prev_tsc);
+      s.window_msg_per_second.push_back(ns > 0 ? msg_per_window * NANO_PER_SEC / ns : 0);
+      s.max_window_ns = std::max(s.max_window_ns, ns);
+      prev_tsc = tsc;
+    }
+
+    s.warmup_window_num = detect_warmup_windows(s.window_msg_per_second);
+    s.steady_msg_per_second =
+      median(std::vector<double>(s.window_msg_per_second.begin() + s.warmup_window_num,
+                                 s.window_msg_per_second.end()));
+    s.worst_window_msg_per_second =
+      *std::min_element(s.window_msg_per_second.begin(), s.window_msg_per_second.end());
+    return s;
+  }
+};
@@ -0,0 +1,122 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "utils.h"
+#include <algorithm>
+#include <cpuid.h>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <x86intrin.h>
+
+class TscClock
+{
+  double cycles_per_ns_;
+  bool invariant_;
+
+  static uint64_t monotonic_raw_ns()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * NANO_PER_SEC + ts.tv_nsec;
+  }
+
+  // takes a (tsc, ns) pair where the clock_gettime call is bracketed by the tightest pair of
+  // TSC reads out of a few attempts, so that a preemption in the middle does not skew the sample
+  static void sample(uint64_t& tsc, uint64_t& ns)
+  {
+    uint64_t best_window = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < 16; ++i)
+    {
+      uint64_t before = rdtscp();
+      uint64_t now_ns = monotonic_raw_ns();
+      uint64_t after = rdtscp();
+      if (after - before < best_window)
+      {
+        best_window = after - before;
+        tsc = before + (after - before) / 2;
+        ns = now_ns;
+      }
+    }
+  }
+
+  TscClock() : cycles_per_ns_(0), invariant_(detect_invariant())
+  {
+    if (!invariant_)
+    {
+      std::cerr << "WARNING: CPU does not report invariant TSC, cycles to nanoseconds "
+                   "translation might be inaccurate\n";
+    }
+
+    // calibrate against CLOCK_MONOTONIC_RAW which is not subject to NTP adjustments, take the
+    // median of a few short rounds so that a single noisy round does not define the frequency
+    constexpr size_t ROUNDS_NUM = 5;
+    constexpr uint64_t ROUND_NS = 20 * NANO_PER_MICRO * MICRO_PER_MILLI;
+    double rounds[ROUNDS_NUM];
+    for (size_t r = 0; r < ROUNDS_NUM; ++r)
+    {
+      uint64_t start_tsc = 0, start_ns = 0, end_tsc = 0, end_ns = 0;
+      sample(start_tsc, start_ns);
+      while (monotonic_raw_ns() - start_ns < ROUND_NS)
+        _mm_pause();
+      sample(end_tsc, end_ns);
+      rounds[r] = static_cast<double>(end_tsc - start_tsc) / static_cast<double>(end_ns - start_ns);
+    }
+
+    std::sort(rounds, rounds + ROUNDS_NUM);
+    cycles_per_ns_ = rounds[ROUNDS_NUM / 2];
+  }
+
+public:
+  TscClock(const TscClock&) = delete;
+  TscClock& operator=(const TscClock&) = delete;
+
+  // calibration takes ~100ms, so make sure the first call happens outside of any measured window
+  static const TscClock& instance()
+  {
+    static const TscClock clock;
+    return clock;
+  }
+
+  // CPUID.80000007H:EDX[8] - TSC ticks at a constant rate across P/C/T-states
+  static bool detect_invariant()
+  {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007)
+      return false;
+
+    __cpuid(0x80000007, eax, ebx, ecx, edx);
+    return (edx & (1u << 8)) != 0;
+  }
+
+  // plain read, can be reordered with the surrounding loads, good enough to mark a start
+  static uint64_t rdtsc() { return __rdtsc(); }
+
+  // waits for all previous instructions to retire, use it to mark an end of a measured interval
+  static uint64_t rdtscp()
+  {
+    unsigned int aux;
+    return __rdtscp(&aux);
+  }
+
+  bool is_invariant() const { return invariant_; }
+  double cycles_per_ns() const { return cycles_per_ns_; }
+  double cycles_to_ns(uint64_t cycles) const { return cycles / cycles_per_ns_; }
+  uint64_t ns_to_cycles(double ns) const { return static_cast<uint64_t>(ns * cycles_per_ns_); }
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 constexpr size_t NANO_PER_MICRO = 1000;
 constexpr size_t MICRO_PER_MILLI = 1000;
 constexpr size_t MILLI_PER_SEC = 1000;
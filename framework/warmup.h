@@ -0,0 +1,147 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tsc_clock.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// How many leading messages of every run are discarded before measuring: page faults on a fresh
+// ring, cold caches/branch predictors and frequency ramp-up are not what a long running process
+// sees. Warmup is carved out of the run's N messages.
+struct WarmupPolicy
+{
+  enum class Kind
+  {
+    None,
+    FixedMsgNum, // discard exactly msg_num messages
+    StableRate   // discard until the rate settles, but at most msg_num messages if it is set
+  };
+
+  Kind kind{Kind::None};
+  size_t msg_num{0};
+  double tolerance{0.1};       // relative, windows within it count as stable
+  size_t stable_window_num{4}; // consecutive stable windows which end the warmup
+
+  bool enabled() const { return kind != Kind::None; }
+
+  // none, fixed:N or stable[:MAX_N]
+  static WarmupPolicy parse(const std::string& s)
+  {
+    WarmupPolicy p;
+    std::string kind = s.substr(0, s.find(':'));
+    std::string arg = s.find(':') == std::string::npos ? "" : s.substr(s.find(':') + 1);
+    if (kind == "none")
+      p.kind = Kind::None;
+    else if (kind == "fixed" && !arg.empty())
+      p.kind = Kind::FixedMsgNum;
+    else if (kind == "stable")
+      p.kind = Kind::StableRate;
+    else
+      throw std::runtime_error("invalid warmup policy [" + s + "], expected none, fixed:N or stable[:N]");
+
+    p.msg_num = arg.empty() ? 0 : std::stoul(arg);
+    return p;
+  }
+
+  std::string to_string() const
+  {
+    switch (kind)
+    {
+    case Kind::FixedMsgNum:
+      return "fixed:" + std::to_string(msg_num);
+    case Kind::StableRate:
+      return msg_num ? "stable:" + std::to_string(msg_num) : "stable";
+    default:
+      return "none";
+    }
+  }
+};
+
+// Online warmup detection over a stream of per-message values, e.g. round trip cycles: values are
+// averaged over windows and the warmup is over once stable_window_num window averages in a row
+// stay within tolerance of each other. absorb() returns true while the value is still warmup.
+class WarmupGate
+{
+public:
+  static constexpr size_t WINDOW_MSG_NUM = 256;
+  static constexpr size_t MAX_STABLE_WINDOW_NUM = 16;
+
+  // max_msg_num bounds the warmup of StableRate policies without their own bound
+  WarmupGate(const WarmupPolicy& policy, size_t max_msg_num) : policy_(policy)
+  {
+    if (policy_.stable_window_num == 0 || policy_.stable_window_num > MAX_STABLE_WINDOW_NUM)
+      throw std::runtime_error("stable_window_num must be within [1, 16]");
+
+    if (policy_.kind == WarmupPolicy::Kind::FixedMsgNum)
+      limit_ = policy_.msg_num;
+    else
+      limit_ = policy_.msg_num ? std::min(policy_.msg_num, max_msg_num) : max_msg_num;
+    done_ = !policy_.enabled() || limit_ == 0;
+  }
+
+  bool done() const { return done_; }
+  size_t discarded_msg_num() const { return discarded_; }
+  uint64_t end_tsc() const { return end_tsc_; } // 0 if warmup never ran
+
+  bool absorb(uint64_t v)
+  {
+    if (done_)
+      return false;
+
+    ++discarded_;
+    if (policy_.kind == WarmupPolicy::Kind::StableRate)
+    {
+      window_sum_ += v;
+      if (discarded_ % WINDOW_MSG_NUM == 0)
+      {
+        window_means_[window_num_++ % policy_.stable_window_num] =
+          static_cast<double>(window_sum_) / WINDOW_MSG_NUM;
+        window_sum_ = 0;
+        done_ = window_num_ >= policy_.stable_window_num && stable();
+      }
+    }
+
+    if (discarded_ >= limit_)
+      done_ = true;
+
+    if (done_)
+      end_tsc_ = TscClock::rdtsc();
+    return true;
+  }
+
+private:
+  WarmupPolicy policy_;
+  size_t limit_{0};
+  bool done_{true};
+  size_t discarded_{0};
+  uint64_t end_tsc_{0};
+  uint64_t window_sum_{0};
+  size_t window_num_{0};
+  std::array<double, MAX_STABLE_WINDOW_NUM> window_means_{};
+
+  bool stable() const
+  {
+    auto [lo, hi] = std::minmax_element(window_means_.begin(),
+                                        window_means_.begin() + policy_.stable_window_num);
+    return *hi <= *lo * (1 + policy_.tolerance);
+  }
+};
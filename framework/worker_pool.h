@@ -0,0 +1,213 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// thrown by a body which gave up waiting for the other bodies of its run, as one of them failed
+struct RunAborted : std::runtime_error
+{
+  RunAborted() : std::runtime_error("run aborted as another thread of it failed") {}
+};
+
+// Long lived threads which benchmark runs dispatch their producer/consumer bodies to, so that a
+// suite does not create thousands of threads and every run after the first one starts on warm
+// stacks, TLBs and caches. Worker N always runs the N-th thread of a benchmark, hence it keeps
+// its pinning between runs of the same placement.
+class WorkerPool
+{
+  struct Worker
+  {
+    std::mutex guard;
+    std::condition_variable_any cv; // _any, as it can be woken up by the stop_token
+    std::function<void()> task;
+    bool busy{false};
+    std::exception_ptr error;
+    bool error_is_abort{false}; // the body only gave up because another one failed
+    std::jthread thread; // must be the last one, so that it is stopped before the rest is destroyed
+
+    explicit Worker(std::atomic_bool& run_aborted)
+      : thread(
+          [this, &run_aborted](std::stop_token stop)
+          {
+            while (true)
+            {
+              std::function<void()> current;
+              {
+                std::unique_lock lock(guard);
+                cv.wait(lock, stop, [this]() { return busy; });
+                if (!busy)
+                  return; // stop requested
+
+                current = std::move(task);
+              }
+
+              std::exception_ptr current_error;
+              bool current_error_is_abort = false;
+              try
+              {
+                current();
+              }
+              catch (const RunAborted&)
+              {
+                current_error = std::current_exception();
+                current_error_is_abort = true;
+              }
+              catch (...)
+              {
+                current_error = std::current_exception();
+                run_aborted.store(true, std::memory_order_release);
+              }
+
+              {
+                std::unique_lock lock(guard);
+                error = current_error;
+                error_is_abort = current_error_is_abort;
+                busy = false;
+              }
+              cv.notify_all();
+            }
+          })
+    {
+    }
+  };
+
+  std::deque<std::unique_ptr<Worker>> workers_;
+  std::atomic_bool run_aborted_{false};
+
+  [[noreturn]] static void terminate_stuck_run(const std::exception_ptr& error)
+  {
+    try
+    {
+      std::rethrow_exception(error);
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << "FATAL: " << e.what() << "\n";
+    }
+    catch (...)
+    {
+      std::cerr << "FATAL: unknown error\n";
+    }
+
+    std::cerr << "the other threads of the run did not give up within "
+              << std::chrono::duration_cast<std::chrono::seconds>(ABORT_GRACE).count()
+              << "s, they are likely stuck in queue calls which cannot be interrupted\n";
+    std::terminate();
+  }
+
+public:
+  // how long the rest of a failed run gets to unwind before the process is terminated
+  static constexpr std::chrono::milliseconds ABORT_GRACE{5000};
+
+  WorkerPool() = default;
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  size_t size() const { return workers_.size(); }
+
+  // workers are created on demand, the body must not outlive the next join_all() call
+  void launch(size_t worker_idx, std::function<void()> body)
+  {
+    while (workers_.size() <= worker_idx)
+      workers_.emplace_back(std::make_unique<Worker>(run_aborted_));
+
+    Worker& w = *workers_[worker_idx];
+    {
+      std::unique_lock lock(w.guard);
+      if (w.busy)
+        throw std::logic_error("worker is still running the previous task");
+
+      w.task = std::move(body);
+      w.error = nullptr;
+      w.busy = true;
+    }
+    w.cv.notify_all();
+  }
+
+  // Set once a body of the current run has thrown. Bodies which wait for each other have to check
+  // it, see throw_if_aborted(), otherwise they would wait for the failed one forever.
+  const std::atomic_bool& run_aborted() const { return run_aborted_; }
+
+  void throw_if_aborted() const
+  {
+    if (run_aborted_.load(std::memory_order_acquire)) [[unlikely]]
+      throw RunAborted();
+  }
+
+  // Waits for every launched body and rethrows the exception which failed the run. Bodies spinning
+  // inside queue calls cannot be interrupted, so if they do not return within ABORT_GRACE of the
+  // failure, the error is reported and the process terminated instead of hanging.
+  void join_all()
+  {
+    std::exception_ptr first_error;
+    std::chrono::steady_clock::time_point abort_deadline{};
+    for (auto& w : workers_)
+    {
+      std::unique_lock lock(w->guard);
+      while (!w->cv.wait_for(lock, std::chrono::milliseconds(10), [&]() { return !w->busy; }))
+      {
+        if (!run_aborted_.load(std::memory_order_acquire))
+          continue;
+
+        auto now = std::chrono::steady_clock::now();
+        if (abort_deadline == std::chrono::steady_clock::time_point{})
+          abort_deadline = now + ABORT_GRACE;
+        else if (now > abort_deadline)
+          terminate_stuck_run(first_error ? first_error : failed_run_error(*w));
+      }
+
+      if (w->error && !w->error_is_abort && !first_error)
+        first_error = w->error;
+      w->error = nullptr;
+    }
+
+    bool aborted = run_aborted_.exchange(false);
+    if (first_error)
+      std::rethrow_exception(first_error);
+    if (aborted)
+      throw std::logic_error("run aborted without an error");
+  }
+
+private:
+  // the error of a body which has already returned, with the rest of the run still stuck
+  std::exception_ptr failed_run_error(const Worker& waited_for)
+  {
+    for (auto& w : workers_)
+    {
+      if (w.get() == &waited_for) // its guard is held by join_all()
+        continue;
+
+      std::unique_lock lock(w->guard);
+      if (lock.owns_lock() && w->error && !w->error_is_abort)
+        return w->error;
+    }
+
+    return std::make_exception_ptr(std::runtime_error("a benchmark thread failed"));
+  }
+};
@@ -0,0 +1,9 @@
+import pandas
+import sys
+# message size scaling, e.g. of qbench --filter '^grid_.*_payload': one row per topology and message size, one column per vendor
+df = pandas.read_csv(sys.stdin)
+df['topology'] = df['producer_n'].astype(str) + 'x' + df['consumer_n'].astype(str)
+for metric in ['50_msg_sec', 'bytes_sec']:
+    print(metric)
+    print(df.pivot_table(index=['topology', 'msg_bytes'], columns='vendor', values=metric, aggfunc='median').to_markdown())
+    print()
@@ -0,0 +1,206 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "checked_message.h"
+#include "factory.h"
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+struct CountingProcessor
+{
+  size_t num{0};
+  void operator()(uint64_t) { ++num; }
+};
+
+SequenceCheck consumer_of(uint32_t producer_id, const std::vector<uint64_t>& seq_nums)
+{
+  SequenceCheck c;
+  for (uint64_t seq_num : seq_nums)
+    c.on_message(producer_id, seq_num);
+  return c;
+}
+} // namespace
+
+TEST_CASE("complete sequences pass both merges")
+{
+  SECTION("multicast, every consumer sees every message")
+  {
+    SequenceCheck a = consumer_of(0, {0, 1, 2, 3});
+    SequenceCheck b = consumer_of(0, {0, 1, 2, 3});
+    REQUIRE(SequenceCheck::merge({a, b}, true).ok());
+  }
+
+  SECTION("anycast, consumers split the messages")
+  {
+    SequenceCheck a = consumer_of(0, {0, 2, 4});
+    SequenceCheck b = consumer_of(0, {1, 3, 5});
+    REQUIRE(SequenceCheck::merge({a, b}, false).ok());
+  }
+
+  SECTION("the newest messages may be left in the queue")
+  {
+    REQUIRE(SequenceCheck::merge({consumer_of(0, {0, 1}), consumer_of(0, {0, 1, 2})}, true).ok());
+    REQUIRE(SequenceCheck::merge({consumer_of(0, {0, 1}), consumer_of(0, {2})}, false).ok());
+  }
+}
+
+TEST_CASE("lost messages")
+{
+  SECTION("multicast counts the holes of every consumer")
+  {
+    SequenceCheck a = consumer_of(0, {0, 1, 3, 4});
+    SequenceCheck b = consumer_of(0, {0, 4});
+    SequenceCheck check = SequenceCheck::merge({a, b}, true);
+    REQUIRE(check.lost_num == 4);
+    REQUIRE(check.duplicate_num == 0);
+    REQUIRE_FALSE(check.ok());
+  }
+
+  SECTION("anycast counts the holes of the union")
+  {
+    SequenceCheck a = consumer_of(0, {0, 2, 6});
+    SequenceCheck b = consumer_of(0, {1, 3, 5});
+    SequenceCheck check = SequenceCheck::merge({a, b}, false);
+    REQUIRE(check.lost_num == 1);
+    REQUIRE_FALSE(check.ok());
+  }
+
+  SECTION("producers are checked separately")
+  {
+    SequenceCheck a = consumer_of(0, {0, 1, 2});
+    a.on_message(1, 0);
+    a.on_message(1, 2);
+    REQUIRE(SequenceCheck::merge({a}, true).lost_num == 1);
+    REQUIRE(SequenceCheck::merge({a}, false).lost_num == 1);
+  }
+}
+
+TEST_CASE("duplicated messages")
+{
+  SECTION("by the same consumer, under both merges")
+  {
+    SequenceCheck a = consumer_of(0, {0, 1, 1, 2});
+    REQUIRE(a.duplicate_num == 1);
+    REQUIRE(SequenceCheck::merge({a}, true).duplicate_num == 1);
+    REQUIRE(SequenceCheck::merge({a}, false).duplicate_num == 1);
+  }
+
+  SECTION("by several anycast consumers")
+  {
+    SequenceCheck a = consumer_of(0, {0, 1, 2});
+    SequenceCheck b = consumer_of(0, {2, 3});
+    SequenceCheck check = SequenceCheck::merge({a, b}, false);
+    REQUIRE(check.duplicate_num == 1);
+    REQUIRE(check.lost_num == 0);
+  }
+
+  SECTION("several multicast consumers seeing the same message is not one")
+  {
+    SequenceCheck a = consumer_of(0, {0, 1, 2});
+    SequenceCheck b = consumer_of(0, {0, 1, 2});
+    REQUIRE(SequenceCheck::merge({a, b}, true).duplicate_num == 0);
+  }
+}
+
+TEST_CASE("reordered messages")
+{
+  SequenceCheck a = consumer_of(0, {0, 2, 1, 3});
+  REQUIRE(a.reorder_num == 1);
+
+  SequenceCheck multicast = SequenceCheck::merge({a, consumer_of(0, {0, 1, 2, 3})}, true);
+  REQUIRE(multicast.reorder_num == 1);
+  REQUIRE(multicast.lost_num == 0);
+
+  SequenceCheck anycast = SequenceCheck::merge({a, consumer_of(0, {4, 5})}, false);
+  REQUIRE(anycast.reorder_num == 1);
+  REQUIRE(anycast.lost_num == 0);
+  REQUIRE_FALSE(anycast.ok());
+
+  // interleaving of different producers is not a reorder
+  SequenceCheck b;
+  b.on_message(1, 0);
+  b.on_message(0, 0);
+  b.on_message(1, 1);
+  b.on_message(0, 1);
+  REQUIRE(b.reorder_num == 0);
+}
+
+TEST_CASE("torn messages")
+{
+  ProduceChecked<uint64_t, ProduceIncremental<uint64_t>> producer;
+  ConsumeChecked<uint64_t, CountingProcessor> consumer;
+  producer.set_producer_id(1);
+
+  CheckedMessage<uint64_t> intact = producer();
+  REQUIRE(intact.intact());
+
+  SECTION("a changed payload, sequence number or producer fails the checksum")
+  {
+    CheckedMessage<uint64_t> torn = producer();
+    torn.payload ^= 1;
+    REQUIRE_FALSE(torn.intact());
+
+    torn = producer();
+    ++torn.seq_num;
+    REQUIRE_FALSE(torn.intact());
+
+    torn = producer();
+    torn.producer_id = 0;
+    REQUIRE_FALSE(torn.intact());
+  }
+
+  SECTION("torn messages are counted and not processed, under both merges")
+  {
+    CheckedMessage<uint64_t> torn = producer();
+    torn.payload ^= 1;
+
+    consumer(intact);
+    consumer(torn);
+    REQUIRE(consumer.processor.num == 1);
+    REQUIRE(consumer.sequence_check().torn_num == 1);
+
+    std::vector<SequenceCheck> consumers{consumer.sequence_check(), consumer.sequence_check()};
+    REQUIRE(SequenceCheck::merge(consumers, true).torn_num == 2);
+    REQUIRE(SequenceCheck::merge(consumers, false).torn_num == 2);
+  }
+}
+
+TEST_CASE("reserved sequences do not change the outcome")
+{
+  SequenceCheck a;
+  a.reserve(4, 1000);
+  for (uint64_t seq_num : {0, 1, 3})
+    a.on_message(2, seq_num);
+  a.on_message(2, 3);
+
+  for (bool multicast : {true, false})
+  {
+    SequenceCheck check = SequenceCheck::merge({a}, multicast);
+    REQUIRE(check.lost_num == 1);
+    REQUIRE(check.duplicate_num == 1);
+    REQUIRE(check.reorder_num == 0);
+  }
+
+  // sequences longer than reserved still grow the bitmap
+  a.on_message(0, 5000);
+  REQUIRE(SequenceCheck::merge({a}, true).lost_num == 1 + 5000);
+}
+
+int main(int argc, char* argv[]) { return Catch::Session().run(argc, argv); }
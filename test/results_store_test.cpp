@@ -0,0 +1,228 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "results_store.h"
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+ResultRecord sample_record(const std::string& key)
+{
+  ResultRecord r;
+  r.key = key;
+  r.name = "spsc_uint32";
+  r.vendor = "mgark";
+  r.msg_type = "j";
+  r.ring_buffer_sz = 1024;
+  r.producer_num = 1;
+  r.consumer_num = 2;
+  r.placement = "same_ccx";
+  r.alloc_policy = "thp+node1";
+  r.producer_cores = "0";
+  r.consumer_cores = "2,4";
+  r.metric = "msg_sec";
+  r.higher_is_better = true;
+  r.samples = {1.5e8, 0.1, 123456789.123456789, -2};
+  r.counters["cycles_msg"] = {12.25, 13.5};
+  return r;
+}
+
+ResultRecord round_trip(const ResultRecord& r)
+{
+  std::stringstream ss;
+  write_json(ss, r);
+  return record_from_json(JsonValue::parse(ss.str()));
+}
+
+// removes the file once the test is done, whichever way it ends
+struct TempFile
+{
+  std::string path;
+
+  explicit TempFile(const std::string& name)
+    : path((std::filesystem::temp_directory_path() /
+            (name + "_" + std::to_string(::getpid()) + ".jsonl"))
+             .string())
+  {
+    std::filesystem::remove(path);
+  }
+
+  ~TempFile() { std::filesystem::remove(path); }
+};
+} // namespace
+
+TEST_CASE("records survive write_json and record_from_json")
+{
+  ResultRecord r = sample_record("k");
+  ResultRecord back = round_trip(r);
+  REQUIRE(back.key == r.key);
+  REQUIRE(back.name == r.name);
+  REQUIRE(back.vendor == r.vendor);
+  REQUIRE(back.msg_type == r.msg_type);
+  REQUIRE(back.ring_buffer_sz == r.ring_buffer_sz);
+  REQUIRE(back.producer_num == r.producer_num);
+  REQUIRE(back.consumer_num == r.consumer_num);
+  REQUIRE(back.placement == r.placement);
+  REQUIRE(back.alloc_policy == r.alloc_policy);
+  REQUIRE(back.producer_cores == r.producer_cores);
+  REQUIRE(back.consumer_cores == r.consumer_cores);
+  REQUIRE(back.metric == r.metric);
+  REQUIRE(back.higher_is_better == r.higher_is_better);
+  // written with 17 significant digits, so doubles come back bit for bit
+  REQUIRE(back.samples == r.samples);
+  REQUIRE(back.counters == r.counters);
+
+  SECTION("empty sample and counter arrays")
+  {
+    r.samples.clear();
+    r.counters.clear();
+    r.counters["hitm_msg"] = {};
+    back = round_trip(r);
+    REQUIRE(back.samples.empty());
+    REQUIRE(back.counters.size() == 1);
+    REQUIRE(back.counters.at("hitm_msg").empty());
+  }
+
+  SECTION("records written before alloc_policy and counters existed")
+  {
+    JsonValue v = JsonValue::parse(
+      R"({"record":"benchmark","key":"k","name":"n","vendor":"v","msg_type":"j",)"
+      R"("ring_buffer_sz":64,"producer_n":1,"consumer_n":1,"placement":"","producer_cores":"",)"
+      R"("consumer_cores":"","metric":"msg_sec","higher_is_better":false,"samples":[1, 2]})");
+    ResultRecord old = record_from_json(v);
+    REQUIRE(old.alloc_policy == "default");
+    REQUIRE(old.counters.empty());
+    REQUIRE(old.samples == std::vector<double>{1, 2});
+  }
+}
+
+TEST_CASE("strings are escaped and unescaped")
+{
+  SECTION("quotes, backslashes, newlines and tabs")
+  {
+    ResultRecord r = sample_record("a \"quoted\" back\\slash\nnew line\ttab");
+    std::stringstream ss;
+    write_json(ss, r);
+    REQUIRE(ss.str().find('\n') == ss.str().size() - 1); // one line per record
+    REQUIRE(round_trip(r).key == r.key);
+  }
+
+  SECTION("other control characters go through \\u00XX")
+  {
+    std::string control{'a', '\x01', '\r', '\x1f', '\b', '\f', 'z'};
+    std::stringstream ss;
+    JsonValue::write_string(ss, control);
+    REQUIRE(ss.str() == R"("a\u0001\u000d\u001f\u0008\u000cz")");
+    REQUIRE(JsonValue::parse(ss.str()).string == control);
+
+    ResultRecord r = sample_record(control);
+    REQUIRE(round_trip(r).key == control);
+  }
+
+  SECTION("escapes the writer does not produce are read too")
+  {
+    REQUIRE(JsonValue::parse(R"("\r\b\f\/A")").string == "\r\b\f/A");
+  }
+}
+
+TEST_CASE("JsonValue::parse")
+{
+  JsonValue v =
+    JsonValue::parse(R"( { "a" : [ 1 , -2.5e3 , true , false , null ] , "b" : { } , "c" : [ ] } )");
+  REQUIRE(v.type == JsonValue::Type::Object);
+  REQUIRE(v.at("a").array.size() == 5);
+  REQUIRE(v.at("a").array[0].number == 1);
+  REQUIRE(v.at("a").array[1].number == -2500);
+  REQUIRE(v.at("a").array[2].boolean);
+  REQUIRE(v.at("a").array[3].type == JsonValue::Type::Bool);
+  REQUIRE_FALSE(v.at("a").array[3].boolean);
+  REQUIRE(v.at("a").array[4].type == JsonValue::Type::Null);
+  REQUIRE(v.at("b").object.empty());
+  REQUIRE(v.at("c").array.empty());
+  REQUIRE_FALSE(v.has("d"));
+  REQUIRE_THROWS_AS(v.at("d"), std::runtime_error);
+
+  SECTION("a repeated name keeps the last value")
+  {
+    REQUIRE(JsonValue::parse(R"({"x":1,"x":2})").at("x").number == 2);
+  }
+
+  SECTION("malformed input")
+  {
+    REQUIRE_THROWS_AS(JsonValue::parse(R"({"a":1} x)"), std::runtime_error);
+    REQUIRE_THROWS_AS(JsonValue::parse(R"({"a" 1})"), std::runtime_error);
+    REQUIRE_THROWS_AS(JsonValue::parse(R"([1, 2)"), std::runtime_error);
+    REQUIRE_THROWS_AS(JsonValue::parse(""), std::runtime_error);
+  }
+}
+
+TEST_CASE("ResultsStore::load")
+{
+  TempFile file("results_store_test");
+
+  RunEnvironment env;
+  env.git_rev = "abc";
+  env.mode = "throughput";
+
+  ResultRecord first = sample_record("same");
+  ResultRecord other = sample_record("other");
+  ResultRecord second = sample_record("same");
+  second.samples = {42};
+  second.counters.clear();
+
+  {
+    ResultsStore store(file.path, env);
+    store.add({first, other});
+  }
+  {
+    // appending to the same file, e.g. a later run of the same benchmark
+    ResultsStore store(file.path, env);
+    store.add({second});
+  }
+
+  SECTION("the last record of a repeated key wins")
+  {
+    auto records = ResultsStore::load(file.path);
+    REQUIRE(records.size() == 2);
+    REQUIRE(records.at("same").samples == std::vector<double>{42});
+    REQUIRE(records.at("same").counters.empty());
+    REQUIRE(records.at("other").samples == other.samples);
+    REQUIRE(records.at("other").counters == other.counters);
+  }
+
+  SECTION("environment records and blank lines are skipped")
+  {
+    {
+      std::ofstream f(file.path, std::ios::app);
+      f << "\n  \r\n";
+    }
+    REQUIRE(ResultsStore::load(file.path).size() == 2);
+  }
+
+  SECTION("missing file")
+  {
+    REQUIRE_THROWS_AS(ResultsStore::load(file.path + ".missing"), std::runtime_error);
+  }
+}
+
+int main(int argc, char* argv[]) { return Catch::Session().run(argc, argv); }
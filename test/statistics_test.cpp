@@ -0,0 +1,208 @@
+/*
+ * Copyright(c) 2024-present Mykola Garkusha.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "statistics.h"
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+#include <vector>
+
+using Catch::Approx;
+
+TEST_CASE("quantile_sorted interpolates linearly like numpy's default")
+{
+  // numpy.quantile(a, q) with method="linear"
+  std::vector<double> four{1, 2, 3, 4};
+  REQUIRE(quantile_sorted(four, 0.25) == Approx(1.75));
+  REQUIRE(quantile_sorted(four, 0.5) == Approx(2.5));
+  REQUIRE(quantile_sorted(four, 0.9) == Approx(3.7));
+
+  std::vector<double> five{15, 20, 35, 40, 50};
+  REQUIRE(quantile_sorted(five, 0.4) == Approx(29));
+  REQUIRE(quantile_sorted(five, 0.5) == Approx(35));
+  REQUIRE(quantile_sorted(five, 0.99) == Approx(49.6));
+
+  SECTION("ends and out of range q")
+  {
+    REQUIRE(quantile_sorted(five, 0) == 15);
+    REQUIRE(quantile_sorted(five, 1) == 50);
+    REQUIRE(quantile_sorted(five, -0.5) == 15);
+    REQUIRE(quantile_sorted(five, 1.5) == 50);
+  }
+
+  SECTION("single and no sample")
+  {
+    REQUIRE(quantile_sorted({7}, 0.3) == 7);
+    REQUIRE_THROWS_AS(quantile_sorted({}, 0.5), std::runtime_error);
+  }
+
+  SECTION("unsorted input goes through quantile()")
+  {
+    REQUIRE(quantile({4, 1, 3, 2}, 0.25) == Approx(1.75));
+    REQUIRE(median({50, 15, 40, 20, 35}) == Approx(35));
+  }
+}
+
+TEST_CASE("bootstrap_median_ci")
+{
+  SECTION("no spread gives a zero width interval")
+  {
+    ConfidenceInterval ci = bootstrap_median_ci(std::vector<double>(20, 3.5));
+    REQUIRE(ci.lower == 3.5);
+    REQUIRE(ci.upper == 3.5);
+    REQUIRE(ci.relative_width_pct(3.5) == 0);
+  }
+
+  SECTION("width is relative to the given median, not to the interval midpoint")
+  {
+    ConfidenceInterval ci{10, 30};
+    REQUIRE(ci.relative_width_pct(15) == Approx(133.33333));
+    REQUIRE(ci.relative_width_pct(20) == Approx(100));
+    REQUIRE(ci.relative_width_pct(0) == 0);
+  }
+
+  SECTION("brackets the median and is reproducible with the same seed")
+  {
+    std::vector<double> samples;
+    for (int i = 1; i <= 101; ++i)
+      samples.push_back(i);
+
+    ConfidenceInterval ci = bootstrap_median_ci(samples);
+    REQUIRE(ci.lower < 51);
+    REQUIRE(ci.upper > 51);
+    // the median of 101 uniform ranks has a standard error of ~7.3, so the 95% CI is ~+-14
+    REQUIRE(ci.lower > 30);
+    REQUIRE(ci.upper < 72);
+
+    ConfidenceInterval again = bootstrap_median_ci(samples);
+    REQUIRE(again.lower == ci.lower);
+    REQUIRE(again.upper == ci.upper);
+
+    ConfidenceInterval narrower = bootstrap_median_ci(samples, 0.5);
+    REQUIRE(narrower.lower >= ci.lower);
+    REQUIRE(narrower.upper <= ci.upper);
+  }
+
+  SECTION("no samples")
+  {
+    ConfidenceInterval ci = bootstrap_median_ci({});
+    REQUIRE(ci.lower == 0);
+    REQUIRE(ci.upper == 0);
+  }
+}
+
+TEST_CASE("mad_outliers flags by modified z-score")
+{
+  // median 10, MAD 0.5: 30 scores 0.6745 * 20 / 0.5 = 26.98, 11 scores 1.35
+  std::vector<double> samples{10, 11, 9, 10.5, 9.5, 10, 30};
+  REQUIRE(median_absolute_deviation(samples) == Approx(0.5));
+  std::vector<bool> only_last{false, false, false, false, false, false, true};
+  REQUIRE(mad_outliers(samples) == only_last);
+
+  SECTION("threshold")
+  {
+    // 11 and 9 score 1.349
+    std::vector<bool> also_9_and_11{false, true, true, false, false, false, true};
+    REQUIRE(mad_outliers(samples, 1.3) == also_9_and_11);
+    REQUIRE(mad_outliers(samples, 1.4) == only_last);
+  }
+
+  SECTION("zero MAD flags nothing")
+  {
+    REQUIRE(mad_outliers({5, 5, 5, 5, 100}) == std::vector<bool>(5, false));
+    REQUIRE(mad_outliers({}).empty());
+  }
+}
+
+TEST_CASE("mann_whitney_u against hand computed references")
+{
+  SECTION("no ties")
+  {
+    // ranks of a in the pooled sample are 3, 5, 7, 8 and 9: R = 32, U = 32 - 5 * 6 / 2 = 17,
+    // mean 10, variance 5 * 4 * 10 / 12, so z = 7 / 4.0825 and with continuity P(Z > 1.5922)
+    std::vector<double> a{19, 22, 16, 29, 24};
+    std::vector<double> b{20, 11, 17, 12};
+    MannWhitneyResult r = mann_whitney_u(a, b);
+    REQUIRE(r.u == Approx(17));
+    REQUIRE(r.z == Approx(1.7146).epsilon(1e-4));
+    REQUIRE(r.p_greater == Approx(0.05567).epsilon(1e-3));
+    REQUIRE(r.p_less == Approx(0.96690).epsilon(1e-3));
+
+    // U of the other side is n1 * n2 - U
+    MannWhitneyResult swapped = mann_whitney_u(b, a);
+    REQUIRE(swapped.u == Approx(3));
+    REQUIRE(swapped.p_less == Approx(r.p_greater));
+  }
+
+  SECTION("ties share their average rank and shrink the variance")
+  {
+    // 2 appears three times (ranks 2-4, 3 each) and 3 twice (ranks 5-6, 5.5 each):
+    // R = 1 + 3 + 3 + 5.5 = 12.5, U = 2.5, variance 16 / 12 * (9 - (24 + 6) / 56) = 11.2857
+    MannWhitneyResult r = mann_whitney_u({1, 2, 2, 3}, {2, 3, 4, 5});
+    REQUIRE(r.u == Approx(2.5));
+    REQUIRE(r.z == Approx(-1.6372).epsilon(1e-4));
+    REQUIRE(r.p_less == Approx(0.06833).epsilon(1e-3));
+    REQUIRE(r.p_greater == Approx(0.96295).epsilon(1e-3));
+  }
+
+  SECTION("degenerate samples")
+  {
+    MannWhitneyResult same = mann_whitney_u({4, 4, 4}, {4, 4});
+    REQUIRE(same.p_greater == 1);
+    REQUIRE(same.p_less == 1);
+
+    MannWhitneyResult empty = mann_whitney_u({}, {1, 2});
+    REQUIRE(empty.u == 0);
+    REQUIRE(empty.p_greater == 1);
+  }
+}
+
+TEST_CASE("AdaptiveStopping")
+{
+  AdaptiveStopping stopping;
+  stopping.min_iteration_num = 5;
+
+  SECTION("disabled never converges")
+  {
+    REQUIRE_FALSE(stopping.enabled());
+    REQUIRE_FALSE(stopping.converged(std::vector<double>(50, 1)));
+  }
+
+  stopping.max_median_ci_pct = 1;
+  REQUIRE(stopping.enabled());
+
+  SECTION("waits for min_iteration_num samples")
+  {
+    REQUIRE_FALSE(stopping.converged(std::vector<double>(4, 1)));
+    REQUIRE(stopping.converged(std::vector<double>(5, 1)));
+  }
+
+  SECTION("stops once the median CI is narrow enough")
+  {
+    std::vector<double> noisy;
+    for (int i = 0; i < 40; ++i)
+      noisy.push_back(i % 2 ? 100 : 200);
+    REQUIRE_FALSE(stopping.converged(noisy));
+
+    std::vector<double> steady;
+    for (int i = 0; i < 40; ++i)
+      steady.push_back(1000 + i % 3);
+    REQUIRE(stopping.converged(steady));
+  }
+}
+
+int main(int argc, char* argv[]) { return Catch::Session().run(argc, argv); }